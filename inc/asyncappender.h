@@ -0,0 +1,165 @@
+// Copyright (c) 2012, Ilya Arefiev <arefiev.id@gmail.com>
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the
+//    distribution.
+//  * Neither the name of the author nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+// IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+// TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+// PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#pragma once
+
+#include    "libqtlogger_common.h"
+#include    "logwriterinterface.h"
+
+#include    <QString>
+#include    <QStringList>
+#include    <QThread>
+#include    <QMutex>
+#include    <QWaitCondition>
+#include    <QMutexLocker>
+
+namespace ilardm {
+namespace lib {
+namespace qtlogger {
+
+class QtLogger;
+
+/** asynchronous log writer decorator.
+ *
+ * owns another log writer and delivers messages to it
+ * from its own thread, so slow writer (i.e. #FileAppender
+ * on network file system) does not delay logger thread
+ * and other writers:
+ *
+ * LQTL_ADD_LOG_WRITER( new AsyncAppender( QtLogger::getInstance(), new FileAppender( "app.log" ) ) );
+ *
+ * appender should be added to the logger passed to constructor,
+ * it formats notice on dropped messages.
+ *
+ * messages passed by logger thread are queued (up to given
+ * capacity, see AsyncAppender#POLICY for what happens
+ * when queue is full) and passed to wrapped writer in
+ * batches. delivery lag and number of dropped messages
+ * are available for monitoring.
+ *
+ * @author Ilya Arefiev
+ */
+class LIBQTLOGGER_EXPORT AsyncAppender
+    : public QThread,
+      public LogWriterInterface
+{
+public:
+    /** what to do with messages when queue is full.
+     */
+    typedef enum {
+        AP_BLOCK,           /**< logger thread waits for free space */
+        AP_DROP_NEWEST,     /**< new messages are dropped */
+        AP_DROP_OLDEST      /**< the oldest queued messages are dropped */
+    } POLICY;
+
+    /** default queue capacity, messages
+     */
+    static const int DEFAULT_CAPACITY = 65536;
+
+public:
+    AsyncAppender( QtLogger&, LogWriterInterface*, int = DEFAULT_CAPACITY, POLICY = AP_BLOCK );
+    virtual ~AsyncAppender();
+
+public:
+    virtual bool writeLog( QString& );
+    virtual bool writeLogBatch( QStringList& );
+    virtual bool flush();
+    virtual bool sync();
+    virtual bool reopen();
+
+    int pendingMessages();
+    int droppedMessages();
+    qint64 lag();
+    qint64 maxLag();
+
+protected:
+    void run();
+    void dropOldest( int );
+
+protected:
+    /** logger appender is added to
+     */
+    QtLogger& logger;
+    /** wrapped log writer
+     */
+    LogWriterInterface* writer;
+    /** queue capacity, messages
+     */
+    int capacity;
+    /** queue overflow policy
+     */
+    POLICY policy;
+
+    /** messages waiting for delivery
+     */
+    QStringList pending;
+    /** time first of AsyncAppender#pending messages was queued,
+     * nanoseconds since epoch
+     */
+    qint64 pendingSince;
+    /** time first message of batch being delivered was queued,
+     * 0 if no batch is being delivered
+     */
+    qint64 deliveringSince;
+    /** the largest delivery lag seen, nanoseconds
+     */
+    qint64 maxDeliveryLag;
+    /** total number of dropped messages
+     */
+    int dropped;
+    /** number of dropped messages already reported into log
+     */
+    int droppedReported;
+    /** number of flush requests
+     * (see AsyncAppender#flush)
+     */
+    int flushRequested;
+    /** number of flush requests served by delivery thread
+     */
+    int flushCompleted;
+    /** sync wrapped writer after next delivery
+     * (see AsyncAppender#sync)
+     */
+    bool syncRequested;
+    /** delivery thread exit condition
+     */
+    bool stop;
+    /** guards all fields above except AsyncAppender#writer
+     */
+    QMutex queueMutex;
+    /** wakes delivery thread when messages queued
+     */
+    QWaitCondition queuedWait;
+    /** wakes blocked logger thread when messages delivered
+     */
+    QWaitCondition deliveredWait;
+};
+
+}   // qtlogger
+}   // lib
+}   // ilardm
@@ -50,6 +50,8 @@ public:
 
 public:
     virtual bool writeLog( QString& );
+    virtual bool writeLogBatch( QStringList& );
+    virtual bool flush();
 };
 
 }   // qtlogger
@@ -0,0 +1,132 @@
+// Copyright (c) 2012, Ilya Arefiev <arefiev.id@gmail.com>
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the
+//    distribution.
+//  * Neither the name of the author nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+// IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+// TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+// PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#pragma once
+
+#include    "libqtlogger_common.h"
+
+#include    <QString>
+#include    <QStringList>
+#include    <QByteArray>
+#include    <QList>
+#include    <QThread>
+
+namespace ilardm {
+namespace lib {
+namespace qtlogger {
+
+class QtLogger;
+
+/** local control endpoint of logger.
+ *
+ * listens on Unix domain socket and serves one text command
+ * per connection, so running application may be inspected
+ * and tuned with qtloggerctl tool or any socket client
+ * (i.e. socat):
+ *
+ * list -- known modules with their levels<br>
+ * set {module} {level} [{seconds}] -- set module level,
+ * restore previous one after given time if passed<br>
+ * reset {module} -- module inherits level from parent again<br>
+ * flush [{timeout}] -- see QtLogger#flush, timeout is milliseconds,
+ * limited by ControlServer#MAX_FLUSH_TIMEOUT<br>
+ * rotate -- reopen writers (see QtLogger#reopenWriters)<br>
+ * stats -- see QtLogger#getStatistics
+ *
+ * level is passed as number or as its description
+ * (see QtLogger#getLogLevelsDescription). response lines
+ * start with "OK" or "ERROR" unless command lists values.
+ *
+ * POSIX only: ControlServer#isListening is false on
+ * other platforms. started by QtLogger#startControlServer.
+ *
+ * @author Ilya Arefiev
+ */
+class LIBQTLOGGER_EXPORT ControlServer
+    : public QThread
+{
+public:
+    /** maximum command length, bytes
+     */
+    static const int MAX_COMMAND = 1024;
+    /** client socket inactivity timeout, milliseconds
+     */
+    static const int CLIENT_TIMEOUT = 1000;
+    /** socket polling interval, milliseconds
+     */
+    static const int POLL_INTERVAL = 200;
+    /** maximum "flush" command timeout, milliseconds
+     */
+    static const int MAX_FLUSH_TIMEOUT = 60000;
+
+public:
+    ControlServer( QtLogger&, const QString& );
+    virtual ~ControlServer();
+
+public:
+    bool isListening() const;
+
+protected:
+    void run();
+    void serveClient( int );
+    QByteArray execute( const QString& );
+    QByteArray listModules();
+    QByteArray setLevel( const QStringList& );
+    void restoreLevels( bool );
+    int parseLevel( const QString& );
+
+protected:
+    /** module level to restore after timeout
+     */
+    typedef struct {
+        QString module;     /**< module name */
+        int     level;      /**< previous level, -1 if inherited */
+        qint64  expires;    /**< restore time, nanoseconds (see LogTimestamp#now) */
+    } TEMPORARY_LEVEL;
+
+    /** controlled logger
+     */
+    QtLogger& logger;
+    /** socket path
+     */
+    QByteArray path;
+    /** listening socket, -1 if not listening
+     */
+    int listenFd;
+    /** server thread exit condition
+     */
+    volatile bool stop;
+    /** levels set for a while by "set" command,
+     * accessed by server thread only
+     */
+    QList< TEMPORARY_LEVEL > temporaryLevels;
+};
+
+}   // qtlogger
+}   // lib
+}   // ilardm
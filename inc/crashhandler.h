@@ -0,0 +1,70 @@
+// Copyright (c) 2012, Ilya Arefiev <arefiev.id@gmail.com>
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the
+//    distribution.
+//  * Neither the name of the author nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+// IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+// TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+// PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#pragma once
+
+#include    "libqtlogger_common.h"
+
+#include    <QString>
+
+namespace ilardm {
+namespace lib {
+namespace qtlogger {
+
+/** fatal signal handler writing pending log records.
+ *
+ * on SIGSEGV, SIGBUS, SIGILL, SIGFPE or SIGABRT writes all
+ * records not yet consumed by logger thread (see
+ * LogRingBuffer#dumpAll) to file descriptor opened at install
+ * time, using only async-signal-safe calls, then passes signal
+ * to previously installed handler (or default action).
+ *
+ * records already taken by logger thread but not yet written
+ * by log writers are not dumped.
+ *
+ * POSIX only: CrashHandler#install fails on other platforms.
+ *
+ * @author Ilya Arefiev
+ */
+class LIBQTLOGGER_EXPORT CrashHandler
+{
+public:
+    static bool install( const QString& );
+    static bool install( int );
+    static void uninstall();
+
+protected:
+    static void handleSignal( int );
+
+private:
+    CrashHandler();
+};
+
+}   // qtlogger
+}   // lib
+}   // ilardm
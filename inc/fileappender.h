@@ -32,6 +32,7 @@
 #include    <QString>
 #include    <QFile>
 #include    <QTextStream>
+#include    <QTextCodec>
 
 namespace ilardm {
 namespace lib {
@@ -42,17 +43,39 @@ namespace qtlogger {
  * creates (if file not exists before) and appends
  * log messages to file.
  *
+ * by default flushes file after each write. with buffer size
+ * set messages are flushed once given number of bytes is
+ * pending, once the oldest pending message waits for given
+ * interval, or when logger thread has no more messages
+ * (see LogWriterInterface#sync):
+ *
+ * LQTL_ADD_LOG_WRITER( new FileAppender( "app.log", 64 * 1024, 1000 ) );
+ *
  * @author Ilya Arefiev
  */
 class LIBQTLOGGER_EXPORT FileAppender
     : public LogWriterInterface
 {
 public:
-    FileAppender( QString );
+    /** MIB enum of UTF-8 codec (see QTextCodec#mibEnum)
+     */
+    static const int UTF8_MIB = 106;
+
+public:
+    FileAppender( QString, int = 0, int = 0 );
     virtual ~FileAppender();
 
 public:
     virtual bool writeLog( QString& );
+    virtual bool writeLogBatch( QStringList& );
+    virtual bool flush();
+    virtual bool sync();
+    virtual bool reopen();
+
+protected:
+    bool open();
+    bool flushIfDue();
+    int encodedSize( const QString& );
 
 protected:
     /** log file handle
@@ -64,6 +87,22 @@ protected:
     /** file and stream succesfully opened flag
      */
     bool valid;
+    /** flush once that many bytes pending,
+     * 0 to flush after each write
+     */
+    int bufferSize;
+    /** flush once the oldest pending message waits
+     * that many milliseconds, 0 to not limit
+     */
+    int flushInterval;
+    /** bytes written since last flush, as encoded
+     * by stream codec (see FileAppender#encodedSize)
+     */
+    int pendingBytes;
+    /** time the oldest pending message was written,
+     * nanoseconds since epoch
+     */
+    qint64 pendingSince;
 };
 
 }   // qtlogger
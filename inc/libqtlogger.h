@@ -32,24 +32,35 @@
 
 #include    "libqtlogger_common.h"
 #include    "logwriterinterface.h"
+#include    "logrecord.h"
+#include    "logargument.h"
+#include    "logtimestamp.h"
+#include    "producercontext.h"
+#include    "logringbuffer.h"
+#include    "logrecordmerger.h"
 
 #include    <QString>
-#include    <QQueue>
 #include    <QMutex>
 #include    <QWaitCondition>
 #include    <QThread>
 #include    <QDateTime>
 #include    <QMap>
+#include    <QHash>
 #include    <QTextStream>
 #include    <QFile>
 #include    <QTextStream>
 #include    <QSettings>
 #include    <QStringList>
+#include    <QAtomicInt>
+#include    <QAtomicPointer>
+#include    <QVector>
 
 namespace ilardm {
 namespace lib {
 namespace qtlogger {
 
+class ControlServer;
+
 /** main logger class.
  *
  * Implements sigletone pattern to use C macroses without constructing
@@ -60,6 +71,11 @@ namespace qtlogger {
  * application exit macro #LQTL_FINISH_LOGGING must be called to correctly
  * process all passed log messages.
  *
+ * Additional independent instances (with own queue, thread, writers
+ * and module levels) may be constructed directly and used with
+ * LOG_*_TO macros. Module ids (see QtLogger#registerModule) are shared
+ * by all instances.
+ *
  * Inherites QThread.
  *
  * @author Iya Arefiev
@@ -86,83 +102,542 @@ public:
     } LOG_LEVEL;
 
     /** auxiliary structure to hold log level for module.
+     *
+     * level is LL_STUB for module without log level record.
      */
     typedef struct {
-        LOG_LEVEL   level;  /**< log level for module*/
-        bool        final;  /**< determines whether log level may be owerridden */
+        LOG_LEVEL   level;      /**< log level for module*/
+        bool        final;      /**< determines whether log level may be owerridden */
+        bool        inherited;  /**< level is not set for module, but resolved
+                                     from parent module (see QtLogger#resolveModuleLevel) */
     } MODULE_LEVEL;
 
+    /** layout of call-site module level cache used by
+     * QtLogger#isModuleLevelEnabled: level in lower bits,
+     * QtLogger#levelsGeneration in the rest
+     */
+    enum {
+        LEVEL_CACHE_BITS = 4,
+        LEVEL_CACHE_MASK = ( 1 << LEVEL_CACHE_BITS ) - 1
+    };
+
+    /** number of module log level records preallocated
+     * in QtLogger#moduleLevels
+     */
+    enum {
+        MODULE_TABLE_RESERVE = 1024
+    };
+
+    /** message queue engines.
+     *
+     * see QtLogger#setQueueEngine
+     */
+    typedef enum {
+        QE_SHARED_RING,     /**< all threads push into QtLogger#messageRing */
+        QE_THREAD_RINGS     /**< each thread pushes into its own ring */
+    } QUEUE_ENGINE;
+
+    /** per-thread queue engine parameters
+     */
+    enum {
+        THREAD_RING_CAPACITY = 1 << 16,     /**< bytes in ring of each thread */
+        DEFAULT_MERGE_SKEW = 2000           /**< default skew window, microseconds */
+    };
+
+    /** default logger thread polling time before parking,
+     * microseconds (see QtLogger#setConsumerSpin)
+     */
+    enum {
+        DEFAULT_CONSUMER_SPIN = 50
+    };
+
+    /** what to do with message when queue is full.
+     *
+     * see QtLogger#setOverflowPolicy
+     */
+    typedef enum {
+        OP_BLOCK,               /**< wait for free space */
+        OP_DROP_NEWEST,         /**< drop message */
+        OP_DROP_OLDEST,         /**< drop the oldest queued message */
+        OP_DROP_BELOW_LEVEL     /**< drop message less important than given level */
+    } OVERFLOW_POLICY;
+
+    /** maximum number of messages passed to log writers at once
+     * (see QtLogger#writeBatch)
+     */
+    enum {
+        DRAIN_BATCH_SIZE = 256
+    };
+
+    /** bytes in priority lane ring (see QtLogger#setPriorityLane)
+     */
+    enum {
+        PRIORITY_RING_CAPACITY = 1 << 16
+    };
+
 public:
     static QtLogger& getInstance();
-    ~QtLogger();
-
-private:
     QtLogger();
+    ~QtLogger();
 
 public:
     void foo( void* );
     static QString determineModule( const char*, const char* );
+    static int registerModule( const QString& );
+    static QString moduleName( int );
     QString describeLogLevel( QtLogger::LOG_LEVEL );
 
     bool addWriter( LogWriterInterface* );
+    bool removeWriter( LogWriterInterface* );
+    bool replaceWriter( LogWriterInterface*, LogWriterInterface* );
 
     LOG_LEVEL setModuleLevel( QString, LOG_LEVEL, bool=false );
-    const MODULE_LEVEL* getModuleLevel( QString );
+    bool resetModuleLevel( QString );
+    MODULE_LEVEL getModuleLevel( QString );
     bool setSettingsObject( QSettings* = NULL );
     bool saveModuleLevels();
     bool loadModuleLevels();
+    bool setConfigReloadInterval( int );
 
     QStringList getLogLevelsDescription();
-    QMap< QString, MODULE_LEVEL* > getModulesMap();
+    QMap< QString, MODULE_LEVEL > getModulesMap();
+
+    void log( LOG_LEVEL, const QString&, QString, const void*, size_t );
+    void write( LOG_LEVEL, QString, const void*, size_t );
+    void write( LOG_LEVEL, const char*, int, const char*, const void*, size_t, const char*, ... ) LQTL_PRINTF_FORMAT( 8, 9 );
+    void write( LOG_LEVEL, const char*, int, const char*, const void*, size_t, const char*, const LogArgument*, int );
+    QString formatNotice( LOG_LEVEL, const QString& );
+    void setDeferredFormatting( bool );
+    void setTimestampFormat( LogTimestamp::PRECISION, bool=false );
+    void setThreadName( const QString& );
+    void setQueueEngine( QUEUE_ENGINE, int=DEFAULT_MERGE_SKEW );
+    void setQueueCapacity( int, int=0 );
+    void setOverflowPolicy( OVERFLOW_POLICY, LOG_LEVEL=LL_WARNING );
+    int getDroppedMessages( LOG_LEVEL );
+    void setConsumerSpin( int );
+    bool flush( int=-1 );
+    void setFlushLevel( LOG_LEVEL );
+    bool installCrashHandler( const QString& );
+    void setPriorityLane( bool, LOG_LEVEL=LL_WARNING );
+    void reopenWriters();
+    QMap< QString, qint64 > getStatistics();
+    bool startControlServer( const QString& );
+    void stopControlServer();
+
+#ifdef  Q_COMPILER_VARIADIC_TEMPLATES
+    /** type-safe front end for QtLogger#write with '{}'-style format.
+     *
+     * wraps passed arguments into LogArgument array on stack,
+     * so QString, QByteArray and integers passed without conversion.
+     *
+     * @param placeholders  number of '{}' in fmt checked against number
+     *                      of arguments at compile time, -1 to skip check
+     * @param level         message log level
+     * @param file          source file name (__FILE__)
+     * @param line          source line number (__LINE__)
+     * @param function      function signature (#FUNCTION_NAME)
+     * @param data          data to dump in hex if any
+     * @param datasz        size of data to dump
+     * @param fmt           message format, must be string literal
+     * @param args          arguments for fmt
+     */
+    template< int placeholders, typename... Args >
+    void writeArgs( LOG_LEVEL level,
+                    const char* file, int line, const char* function,
+                    const void* data, size_t datasz,
+                    const char* fmt, const Args&... args )
+    {
+        static_assert( placeholders < 0 || placeholders == (int)sizeof...( Args ),
+                       "number of '{}' placeholders does not match number of arguments" );
+
+        // trailing blank argument allows calls without arguments
+        const LogArgument arguments[] = { LogArgument( args )..., LogArgument() };
+
+        write( level, file, line, function, data, datasz, fmt, arguments, (int)sizeof...( Args ) );
+    }
+#endif
+
+#if defined ( Q_COMPILER_CONSTEXPR ) && defined ( Q_COMPILER_VARIADIC_TEMPLATES )
+    /** find the first character of module name at compile time.
+     *
+     * compile-time counterpart of QtLogger#determineModule,
+     * module name is [QtLogger#moduleBegin, QtLogger#moduleEnd)
+     * range of function signature or file name, copied into
+     * static string by StaticModuleName.
+     *
+     * recursion depth equals to function signature
+     * and file path length, so they should fit into
+     * compiler constexpr depth limit.
+     *
+     * @param function  function signature (#FUNCTION_NAME)
+     * @param file      source file name (__FILE__)
+     *
+     * @return the first character of module name
+     */
+    static constexpr const char* moduleBegin( const char* function, const char* file )
+    {
+        return trimBegin( findChar( function, '(' )
+                            ? nameBegin( function, findChar( function, '(' ) )
+                            : fileNameBegin( file, stringEnd( file ) ),
+                          rawModuleEnd( function, file ) );
+    }
+
+    /** find end of module name at compile time.
+     *
+     * see QtLogger#moduleBegin.
+     *
+     * @param function  function signature (#FUNCTION_NAME)
+     * @param file      source file name (__FILE__)
+     *
+     * @return character next to the last one of module name
+     */
+    static constexpr const char* moduleEnd( const char* function, const char* file )
+    {
+        return trimEnd( moduleBegin( function, file ), rawModuleEnd( function, file ) );
+    }
+
+protected:
+    static constexpr bool isSpace( char c )
+    {
+        return ( c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\v' || c == '\f' );
+    }
+
+    static constexpr bool isPathSeparator( char c )
+    {
+#if defined ( Q_OS_WIN32 )
+        return ( c == '\\' );
+#else
+        return ( c == '/' );
+#endif
+    }
+
+    static constexpr const char* findChar( const char* p, char c )
+    {
+        return ( !*p ) ? (const char*)0
+             : ( *p == c ) ? p
+             : findChar( p + 1, c );
+    }
+
+    static constexpr const char* stringEnd( const char* p )
+    {
+        return ( *p ) ? stringEnd( p + 1 ) : p;
+    }
+
+    // function name follows the last space before '('
+    static constexpr const char* nameBegin( const char* function, const char* p )
+    {
+        return ( p == function || p[-1] == ' ' ) ? p : nameBegin( function, p - 1 );
+    }
+
+    // namespace or class ends at the last "::" before '('
+    static constexpr const char* scopeEnd( const char* begin, const char* p, const char* delim )
+    {
+        return ( p - begin < 2 ) ? delim
+             : ( p[-1] == ':' && p[-2] == ':' ) ? p - 2
+             : scopeEnd( begin, p - 1, delim );
+    }
+
+    static constexpr const char* fileNameBegin( const char* path, const char* p )
+    {
+        return ( p == path || isPathSeparator( p[-1] ) ) ? p : fileNameBegin( path, p - 1 );
+    }
+
+    static constexpr const char* rawModuleEnd( const char* function, const char* file )
+    {
+        return findChar( function, '(' )
+                ? scopeEnd( nameBegin( function, findChar( function, '(' ) ),
+                            findChar( function, '(' ),
+                            findChar( function, '(' ) )
+                : stringEnd( file );
+    }
+
+    static constexpr const char* trimBegin( const char* begin, const char* end )
+    {
+        return ( begin < end && isSpace( *begin ) ) ? trimBegin( begin + 1, end ) : begin;
+    }
+
+    static constexpr const char* trimEnd( const char* begin, const char* end )
+    {
+        return ( end > begin && isSpace( end[-1] ) ) ? trimEnd( begin, end - 1 ) : end;
+    }
+
+public:
+#endif
+
+    /** cheap check whether message of given level may be logged at all.
+     *
+     * compares passed level with QtLogger#thresholdLevel -- the most
+     * verbose level assigned to any module (or QtLogger#currentLevel).
+     * used by #LQTL_LOG_WRITE to skip message formatting for messages
+     * which would be rejected by QtLogger#log anyway.
+     *
+     * @param level message log level
+     *
+     * @return true if message may pass module log level check<br>
+     *         false if message would be rejected for sure
+     */
+    inline bool isLevelEnabled( LOG_LEVEL level ) const
+    {
+        return ( (int)level <= (int)thresholdLevel );
+    }
+
+    /** lock-free check whether message of given level may be logged by module.
+     *
+     * uses passed call-site cache which holds module log level
+     * together with QtLogger#levelsGeneration it was resolved at.
+     * cache is refreshed by QtLogger#refreshModuleLevel only when
+     * generation changed, i.e. after any module level change.
+     *
+     * @param level     message log level
+     * @param module    module id returned by QtLogger#registerModule
+     * @param cache     call-site cache, initially 0
+     *
+     * @return true if message passes module log level check<br>
+     *         false otherwise
+     */
+    inline bool isModuleLevelEnabled( LOG_LEVEL level, int module, QBasicAtomicInt& cache )
+    {
+        uint cached = (int)cache;
+        if ( ( cached ^ ( (uint)(int)levelsGeneration << LEVEL_CACHE_BITS ) ) & ~LEVEL_CACHE_MASK )
+        {
+            cached = refreshModuleLevel( module, cache );
+        }
 
-    void log( LOG_LEVEL, QString, QString, const void*, size_t );
+        return ( (uint)level <= ( cached & LEVEL_CACHE_MASK ) );
+    }
+    int refreshModuleLevel( int, QBasicAtomicInt& );
 
     void finishLogging();
 
 protected:
     void run();
+    void writeBatch( QStringList& );
+    bool spinForRecords( LogRecordMerger&, int, bool, int );
+    void flushWriters();
+    void syncWriters();
+    void publishWriters( LogWriterInterface* );
+    void adoptWriters();
+    void completeFlush( int );
+    void appendDropSummary( QStringList&, int* );
+    bool drainPriorityLane( QVector< LogRecord >&, QStringList& );
     QString hexData( const void*, const size_t );
+    void formatPrefix( const LogRecord&, QByteArray&, QString& );
+    QString formatRecord( const LogRecord& );
+    void stampSequence( LogRecord& );
+    void enqueue( const LogRecord& );
+    void wakeConsumer();
+    bool waitForSpace( LogRingBuffer*, const LogRecord&, int, int );
+    void wakeProducers();
+    bool discardOldest( LogRingBuffer* );
+    void countDropped( int );
+    LogRingBuffer* threadRing();
+    void adoptThreadRings( LogRecordMerger&, int& );
+    void updateThresholdLevel();
+    LOG_LEVEL resolveModuleLevel( const QString& );
+    LOG_LEVEL inheritModuleLevel( int, const QString& );
+    MODULE_LEVEL& moduleSlot( int );
+    void applyModuleLevels( QSettings& );
+    void checkConfigReload();
 
 protected:
+    /** unique id of logger instance, distinguishes
+     * its rings in ProducerContext#rings
+     */
+    const int instanceId;
     /** represents default log level <i>module name</i> in config file
       */
     QString defaultModuleLevel;
     /** currently using log level threshold
      */
     LOG_LEVEL currentLevel;
+    /** the most verbose log level among QtLogger#currentLevel
+     * and all levels in QtLogger#moduleLevels.
+     *
+     * read without locking by QtLogger#isLevelEnabled,
+     * updated by QtLogger#updateThresholdLevel
+     */
+    QAtomicInt thresholdLevel;
+    /** module log levels generation.
+     *
+     * incremented on each module log level change
+     * to invalidate call-site caches checked by
+     * QtLogger#isModuleLevelEnabled
+     */
+    QAtomicInt levelsGeneration;
     /** list of string representation of #LOG_LEVEL
      *
      * NOTE: order of filling matters:
      * must be the same as in #LOG_LEVEL enum!
      */
     QStringList ll_string;
+    /** Latin-1 copy of QtLogger#ll_string used by
+     * QtLogger#formatPrefix
+     */
+    QList< QByteArray > ll_latin1;
+
+    /** format messages on logger thread flag.
+     *
+     * see QtLogger#setDeferredFormatting
+     */
+    bool deferredFormatting;
+    /** number of fraction of second digits in message timestamp
+     */
+    LogTimestamp::PRECISION timestampPrecision;
+    /** prepend message timestamp with date flag
+     */
+    bool timestampDate;
 
-    /** log messages queue
+    /** log messages queue, lock-free for producers
+     * and logger thread
+     */
+    LogRingBuffer messageRing;
+    /** priority lane: messages of QtLogger#priorityLevel
+     * and more important ones, drained before
+     * QtLogger#messageRing and per-thread rings
+     */
+    LogRingBuffer priorityRing;
+    /** the least important level passed through
+     * QtLogger#priorityRing, -1 if lane disabled
+     */
+    QAtomicInt priorityLevel;
+    /** the latest LogRecord#sequence, messages are numbered
+     * while priority lane is enabled
+     */
+    QAtomicInt messageSequence;
+    /** logger thread sleeps on QtLogger#mqWait flag.
+     *
+     * checked by producers after each enqueued record,
+     * so QtLogger#mqMutex is locked only to wake
+     * sleeping logger thread
+     */
+    QAtomicInt consumerWaiting;
+    /** number of producers waiting for free space
+     * (see QtLogger#waitForSpace), checked by logger thread
+     * after popping records, so QtLogger#spaceMutex is
+     * locked only to wake waiting producers
+     */
+    QAtomicInt producersWaiting;
+    /** QtLogger#spaceWait guard
+     */
+    QMutex spaceMutex;
+    /** wakes producers waiting for free space
+     */
+    QWaitCondition spaceWait;
+    /** selected #QUEUE_ENGINE
+     */
+    QAtomicInt queueEngine;
+    /** skew window of per-thread rings merge, microseconds
+     * (see LogRecordMerger)
+     */
+    QAtomicInt mergeSkew;
+    /** per-thread rings created since logger thread
+     * last adopted them (see QtLogger#adoptThreadRings)
+     */
+    QList< LogRingBuffer* > newThreadRings;
+    /** #newThreadRings guard
+     */
+    QMutex trMutex;
+    /** incremented each time ring added into #newThreadRings
+     */
+    QAtomicInt threadRingsGeneration;
+    /** queue messages limit, 0 for no limit
+     * (see QtLogger#setQueueCapacity)
      */
-    QQueue< QString > messageQueue;
-    /** message queue guard
+    QAtomicInt queueMessagesLimit;
+    /** queue bytes limit, 0 for ring size
+     * (see QtLogger#setQueueCapacity)
+     */
+    QAtomicInt queueBytesLimit;
+    /** selected #OVERFLOW_POLICY
+     */
+    QAtomicInt overflowPolicy;
+    /** the least important level kept by OP_DROP_BELOW_LEVEL policy
+     */
+    QAtomicInt overflowLevel;
+    /** number of dropped messages per level,
+     * messages of unknown level counted as #LL_STUB
+     */
+    QAtomicInt droppedMessages[ LL_STUB + 1 ];
+    /** total number of dropped messages
+     */
+    QAtomicInt droppedTotal;
+    /** logger thread polling time before parking, microseconds
+     * (see QtLogger#setConsumerSpin)
+     */
+    QAtomicInt consumerSpin;
+    /** sequence number of the latest flush request
+     * (see QtLogger#flush)
+     */
+    QAtomicInt flushRequested;
+    /** sequence number of the latest flush request served
+     * by logger thread
+     */
+    QAtomicInt flushCompleted;
+    /** the least important level synced to writers right
+     * after being written, -1 to sync on idle only
+     * (see QtLogger#setFlushLevel)
+     */
+    QAtomicInt flushLevel;
+    /** QtLogger#flushWait guard
+     */
+    QMutex flushMutex;
+    /** wakes threads waiting in QtLogger#flush
+     */
+    QWaitCondition flushWait;
+    /** serializes popping records from rings by logger thread
+     * and producers discarding the oldest records
+     */
+    QMutex popMutex;
+    /** logger thread wait condition guard
      */
     QMutex mqMutex;
     /** logger thread wait condition
      */
     QWaitCondition mqWait;
-    /** logger thread exit condition
+    /** logger thread exit condition, guarded by QtLogger#mqMutex,
+     * also read by QtLogger#waitForSpace under QtLogger#spaceMutex
      */
     bool shutdown;
 
+    /** writers list published by QtLogger#publishWriters
+     * and not yet adopted by logger thread
+     */
+    typedef struct {
+        QList< LogWriterInterface* > writers;   /**< copy of QtLogger#writersList */
+        QList< LogWriterInterface* > retired;   /**< removed writers to delete */
+    } WRITERS_SNAPSHOT;
+
     /** list of registered log writers
      */
     QList< LogWriterInterface* > writersList;
     /** log writers list guard
      */
     QMutex wlMutex;
+    /** the latest writers list not yet adopted by logger
+     * thread (see QtLogger#adoptWriters), NULL if none
+     */
+    QAtomicPointer< WRITERS_SNAPSHOT > pendingWriters;
+    /** writers used by logger thread, accessed by logger
+     * thread only, so no locking needed
+     */
+    QList< LogWriterInterface* > activeWriters;
 
-    /** mapping of #LOG_LEVEL to module name
+    /** module log levels indexed by module id
+     * (see QtLogger#registerModule).
+     *
+     * preallocated, so first message of module allocates
+     * nothing. records are accessed under QtLogger#mmMutex
+     * only and copied out, so table may grow safely.
      */
-    QMap< QString, MODULE_LEVEL* > moduleMap;
-    /** #moduleMap guard
+    QVector< MODULE_LEVEL > moduleLevels;
+    /** #moduleLevels guard
      */
     QMutex mmMutex;
+    /** ids of modules whose levels were applied from settings
+     * last time (see QtLogger#applyModuleLevels), accessed
+     * under QtLogger#mmMutex only
+     */
+    QList< int > settingsModules;
 
     /** main application settings object where logger settings would be stored
      */
@@ -170,8 +645,101 @@ protected:
     /** logger settings section
      */
     QString settingsSection;
+
+    /** settings file polling interval, milliseconds,
+     * 0 if disabled (see QtLogger#setConfigReloadInterval)
+     */
+    QAtomicInt reloadInterval;
+    /** settings file polled for changes
+     */
+    QString reloadFile;
+    /** format of QtLogger#reloadFile
+     */
+    QSettings::Format reloadFormat;
+    /** modification time of QtLogger#reloadFile seen by last check
+     */
+    QDateTime reloadModified;
+    /** size of QtLogger#reloadFile seen by last check
+     */
+    qint64 reloadSize;
+    /** time of next QtLogger#reloadFile check, nanoseconds
+     * (see LogTimestamp#now)
+     */
+    qint64 reloadCheckTime;
+    /** QtLogger#reloadFile and its check state guard
+     */
+    QMutex rlMutex;
+
+    /** number of QtLogger#reopenWriters requests
+     */
+    QAtomicInt reopenRequested;
+    /** number of messages passed to writers
+     * (modulo 2^32, see QtLogger#getStatistics)
+     */
+    QAtomicInt writtenMessages;
+    /** logger construction time, nanoseconds
+     * (see LogTimestamp#now)
+     */
+    const qint64 startTime;
+    /** control endpoint, NULL if not started
+     * (see QtLogger#startControlServer)
+     */
+    ControlServer* controlServer;
+    /** QtLogger#controlServer guard
+     */
+    QMutex csMutex;
+};
+
+#if defined ( Q_COMPILER_CONSTEXPR ) && defined ( Q_COMPILER_VARIADIC_TEMPLATES )
+/** indices of module name characters (see StaticModuleName)
+ */
+template< int... I >
+struct ModuleNameIndices
+{
+};
+
+/** make ModuleNameIndices 0..N-1
+ */
+template< int N, int... I >
+struct MakeModuleNameIndices
+    : MakeModuleNameIndices< N - 1, N - 1, I... >
+{
+};
+
+template< int... I >
+struct MakeModuleNameIndices< 0, I... >
+{
+    typedef ModuleNameIndices< I... > type;
+};
+
+/** module name built at compile time.
+ *
+ * copies characters between Source::begin() and Source::end()
+ * (see QtLogger#moduleBegin and QtLogger#moduleEnd) into
+ * static string replacing ':' with '-' the same way
+ * QtLogger#determineModule does, so it is never built
+ * at runtime.
+ *
+ * @author Ilya Arefiev
+ */
+template< typename Source,
+          typename Indices = typename MakeModuleNameIndices< (int)( Source::end() - Source::begin() ) >::type >
+struct StaticModuleName;
+
+template< typename Source, int... I >
+struct StaticModuleName< Source, ModuleNameIndices< I... > >
+{
+    /** zero terminated module name
+     */
+    static constexpr char value[ sizeof...( I ) + 1 ] = {
+        ( Source::begin()[ I ] == ':' ? '-' : Source::begin()[ I ] )..., '\0'
+    };
 };
 
+template< typename Source, int... I >
+constexpr char StaticModuleName< Source, ModuleNameIndices< I... > >::value[ sizeof...( I ) + 1 ];
+#endif
+
 /** wrapper for QtLogger#addWriter.
  *
  * should be called before any logging appeared
@@ -179,6 +747,16 @@ protected:
 #define LQTL_ADD_LOG_WRITER( writer )\
     ilardm::lib::qtlogger::QtLogger::getInstance().addWriter( writer )
 
+/** wrapper for QtLogger#removeWriter.
+ */
+#define LQTL_REMOVE_LOG_WRITER( writer )\
+    ilardm::lib::qtlogger::QtLogger::getInstance().removeWriter( writer )
+
+/** wrapper for QtLogger#replaceWriter.
+ */
+#define LQTL_REPLACE_LOG_WRITER( writer, replacement )\
+    ilardm::lib::qtlogger::QtLogger::getInstance().replaceWriter( writer, replacement )
+
 /** wrapper for QtLogger#setSettingsObject
  */
 #define LQTL_SET_SETTINGS_OBJECT( settings )\
@@ -194,6 +772,13 @@ protected:
 #define LQTL_LOAD_LOG_CONFIG()\
     ilardm::lib::qtlogger::QtLogger::getInstance().loadModuleLevels()
 
+/** wrapper for QtLogger#setConfigReloadInterval.
+ *
+ * @param interval settings file polling interval, milliseconds, 0 to disable
+ */
+#define LQTL_SET_CONFIG_RELOAD_INTERVAL( interval )\
+    ilardm::lib::qtlogger::QtLogger::getInstance().setConfigReloadInterval( interval )
+
 /** loads logger config.
  *
  * should be called first (right after QSettings object created)
@@ -251,6 +836,31 @@ protected:
 #define LQTL_DETERMINE_MODULE()\
     ilardm::lib::qtlogger::QtLogger::determineModule(FUNCTION_NAME, __FILE__)
 
+/** defines static module id of call site.
+ *
+ * if compiler supports constexpr module name is extracted
+ * from #FUNCTION_NAME and __FILE__ at compile time
+ * (see StaticModuleName), so call site only registers
+ * static string once. otherwise module name is determined
+ * by QtLogger#determineModule on first call.
+ *
+ * @param id name of defined static int variable
+ */
+#if defined ( Q_COMPILER_CONSTEXPR ) && defined ( Q_COMPILER_VARIADIC_TEMPLATES )
+#define LQTL_DECLARE_MODULE_ID( id )\
+    static constexpr const char* id##Function = FUNCTION_NAME;\
+    struct id##Source\
+    {\
+        static constexpr const char* begin() { return ilardm::lib::qtlogger::QtLogger::moduleBegin( id##Function, __FILE__ ); }\
+        static constexpr const char* end() { return ilardm::lib::qtlogger::QtLogger::moduleEnd( id##Function, __FILE__ ); }\
+    };\
+    static const int id = ilardm::lib::qtlogger::QtLogger::registerModule(\
+                            QString::fromLatin1( ilardm::lib::qtlogger::StaticModuleName< id##Source >::value ) )
+#else
+#define LQTL_DECLARE_MODULE_ID( id )\
+    static const int id = ilardm::lib::qtlogger::QtLogger::registerModule( LQTL_DETERMINE_MODULE() )
+#endif
+
 /** wrapper for QtLogger#setModuleLevel.
  *
  * defines QtLogger#LOG_LEVEL __logLevelFor{...}
@@ -262,6 +872,70 @@ protected:
 #define LQTL_SET_MODULE_LOGLEVEL( name, lvl )\
     ilardm::lib::qtlogger::QtLogger::LOG_LEVEL __loglevelFor##name = ilardm::lib::qtlogger::QtLogger::getInstance().setModuleLevel( LQTL_DETERMINE_MODULE(), lvl )
 
+/** wrapper for QtLogger#setDeferredFormatting
+ */
+#define LQTL_SET_DEFERRED_FORMATTING( enable )\
+    ilardm::lib::qtlogger::QtLogger::getInstance().setDeferredFormatting( enable )
+
+/** wrapper for QtLogger#setThreadName
+ */
+#define LQTL_SET_THREAD_NAME( name )\
+    ilardm::lib::qtlogger::QtLogger::getInstance().setThreadName( name )
+
+/** wrapper for QtLogger#setQueueEngine
+ */
+#define LQTL_SET_QUEUE_ENGINE( engine, skew )\
+    ilardm::lib::qtlogger::QtLogger::getInstance().setQueueEngine( engine, skew )
+
+/** wrapper for QtLogger#setQueueCapacity
+ */
+#define LQTL_SET_QUEUE_CAPACITY( messages, bytes )\
+    ilardm::lib::qtlogger::QtLogger::getInstance().setQueueCapacity( messages, bytes )
+
+/** wrapper for QtLogger#setOverflowPolicy
+ */
+#define LQTL_SET_OVERFLOW_POLICY( policy, level )\
+    ilardm::lib::qtlogger::QtLogger::getInstance().setOverflowPolicy( policy, level )
+
+/** wrapper for QtLogger#setConsumerSpin
+ */
+#define LQTL_SET_CONSUMER_SPIN( spin )\
+    ilardm::lib::qtlogger::QtLogger::getInstance().setConsumerSpin( spin )
+
+/** wrapper for QtLogger#flush
+ *
+ * @param timeout maximum wait time, milliseconds, negative to wait forever
+ */
+#define LQTL_FLUSH( timeout )\
+    ilardm::lib::qtlogger::QtLogger::getInstance().flush( timeout )
+
+/** wrapper for QtLogger#installCrashHandler
+ */
+#define LQTL_INSTALL_CRASH_HANDLER( path )\
+    ilardm::lib::qtlogger::QtLogger::getInstance().installCrashHandler( path )
+
+/** wrapper for QtLogger#startControlServer
+ *
+ * @param path control socket path
+ */
+#define LQTL_START_CONTROL_SERVER( path )\
+    ilardm::lib::qtlogger::QtLogger::getInstance().startControlServer( path )
+
+/** wrapper for QtLogger#setFlushLevel
+ */
+#define LQTL_SET_FLUSH_LEVEL( level )\
+    ilardm::lib::qtlogger::QtLogger::getInstance().setFlushLevel( level )
+
+/** wrapper for QtLogger#setPriorityLane
+ */
+#define LQTL_SET_PRIORITY_LANE( enable, level )\
+    ilardm::lib::qtlogger::QtLogger::getInstance().setPriorityLane( enable, level )
+
+/** wrapper for QtLogger#setTimestampFormat
+ */
+#define LQTL_SET_TIMESTAMP_FORMAT( precision, withDate )\
+    ilardm::lib::qtlogger::QtLogger::getInstance().setTimestampFormat( precision, withDate )
+
 /** wrapper for QtLogger#getLogLevelsDescription
  */
 #define LQTL_GET_LLEVELS_DESCRIPTION()\
@@ -284,10 +958,76 @@ protected:
 #define LQTL_EDIT_MODULE_LLEVEL( module, lvl )\
     ilardm::lib::qtlogger::QtLogger::getInstance().setModuleLevel( module, lvl, true )
 
-/** wrapper for QtLogger#log.
+/** executes passed statement if message of given level passes
+ * module log level check of given logger instance.
+ *
+ * QtLogger#isLevelEnabled allows to skip filtered out
+ * messages with one comparison.
+ *
+ * module name is extracted at compile time if compiler supports
+ * constexpr (see #LQTL_DECLARE_MODULE_ID) and registered once
+ * per call site (on first passed message), its id is stored in function-local
+ * static variable shared by all threads. module log level is cached
+ * per call site as well, so steady-state check takes no locks
+ * (see QtLogger#isModuleLevelEnabled).
+ *
+ * logger is evaluated once and available to statement
+ * as __qtLogger reference.
+ *
+ * @param logger    QtLogger instance
+ * @param lvl       #LOG_LEVEL
+ * @param ...       statement to execute
+ */
+#define LQTL_LOG_IF_ENABLED_TO(logger, lvl, ... )\
+    do {\
+        ilardm::lib::qtlogger::QtLogger& __qtLogger = ( logger );\
+        if ( __qtLogger.isLevelEnabled( lvl ) )\
+        {\
+            LQTL_DECLARE_MODULE_ID( __qtLoggerModule );\
+            static QBasicAtomicInt __qtLoggerModuleLevel = Q_BASIC_ATOMIC_INITIALIZER( 0 );\
+            if ( __qtLogger.isModuleLevelEnabled( lvl, __qtLoggerModule, __qtLoggerModuleLevel ) )\
+            {\
+                __VA_ARGS__;\
+            }\
+        }\
+    } while ( 0 )
+
+/** #LQTL_LOG_IF_ENABLED_TO for default logger instance
+ *
+ * @param lvl       #LOG_LEVEL
+ * @param ...       statement to execute
+ */
+#define LQTL_LOG_IF_ENABLED(lvl, ... )\
+    LQTL_LOG_IF_ENABLED_TO( ilardm::lib::qtlogger::QtLogger::getInstance(), lvl, __VA_ARGS__ )
+
+/** wrapper for QtLogger#write.
  *
  * creates log message in following format:<br>
  * {current_time} {log_level-string} {filename}:{line_number} [{thread_id}] {function_signature} {passed_format}
+ *
+ * message is formed only if passes log level check (see #LQTL_LOG_IF_ENABLED),
+ * either at call site or on logger thread
+ * (see QtLogger#setDeferredFormatting).
+ *
+ * @param logger    QtLogger instance
+ * @param lvl       #LOG_LEVEL
+ * @param fmt       message format
+ * @param data      pointer to data buffer dumped in hex
+ * @param datasz    size of data buffer
+ * @param ...       arguments for fmt
+ */
+#define LQTL_LOG_WRITE_TO(logger, lvl, fmt, data, datasz, ... )\
+    LQTL_LOG_IF_ENABLED_TO( logger, lvl,\
+        __qtLogger.write( lvl,\
+                          __FILE__,\
+                          __LINE__,\
+                          FUNCTION_NAME,\
+                          data, datasz,\
+                          " " fmt ,\
+                          ##__VA_ARGS__\
+                        ) )
+
+/** #LQTL_LOG_WRITE_TO for default logger instance
  *
  * @param lvl       #LOG_LEVEL
  * @param fmt       message format
@@ -296,19 +1036,15 @@ protected:
  * @param ...       arguments for fmt
  */
 #define LQTL_LOG_WRITE(lvl, fmt, data, datasz, ... )\
-    ilardm::lib::qtlogger::QtLogger::getInstance().log( lvl,\
-                                 LQTL_DETERMINE_MODULE(),\
-                                 QString().sprintf( "%s %s %16s:%-5d\t[%p] %s " fmt,\
-                                                    QDateTime::currentDateTime().toString("hh:mm:ss.zzz").toStdString().c_str(),\
-                                                    ilardm::lib::qtlogger::QtLogger::getInstance().describeLogLevel(lvl).toStdString().c_str(),\
-                                                    LQTL_FILENAME_FROM_PATH(__FILE__),\
-                                                    __LINE__,\
-                                                    (void*)QThread::currentThreadId(),\
-                                                    FUNCTION_NAME ,\
-                                                    ##__VA_ARGS__\
-                                                  ),\
-                                 data, datasz\
-                               )
+    LQTL_LOG_WRITE_TO( ilardm::lib::qtlogger::QtLogger::getInstance(),\
+                       lvl, fmt, data, datasz , ##__VA_ARGS__ )
+
+/** substitution for LOG_* macros stripped by #LQTL_MIN_COMPILED_LEVEL.
+ *
+ * expands to empty statement
+ */
+#define LQTL_LOG_STRIPPED()\
+    do {} while ( 0 )
 
 /** wrapper for #LQTL_LOG_WRITE
  *
@@ -335,6 +1071,7 @@ protected:
 #define LOG_ERROR(fmt, ...)\
     LOG_ERRORX( fmt, NULL, 0 , ##__VA_ARGS__ )
 
+#if LQTL_MIN_COMPILED_LEVEL >= 1     // LL_WARNING
 /** wrapper for #LQTL_LOG_WRITE
  *
  * substitudes lvl with QtLogger#LL_WARNING
@@ -347,6 +1084,10 @@ protected:
 #define LOG_WARNX(fmt, data, datasz, ...)\
     LQTL_LOG_WRITE( ilardm::lib::qtlogger::QtLogger::LL_WARNING,\
                     fmt, data, datasz , ##__VA_ARGS__ )
+#else
+#define LOG_WARNX(fmt, data, datasz, ...)\
+    LQTL_LOG_STRIPPED()
+#endif
 /** wrapper for #LOG_WARNX
  *
  * substitudes data with NULL,
@@ -360,6 +1101,7 @@ protected:
 #define LOG_WARN(fmt, ...)\
     LOG_WARNX( fmt, NULL, 0 , ##__VA_ARGS__ )
 
+#if LQTL_MIN_COMPILED_LEVEL >= 2     // LL_WARNING_FINE
 /** wrapper for #LQTL_LOG_WRITE
  *
  * substitudes lvl with QtLogger#LL_WARNING_FINE
@@ -372,6 +1114,10 @@ protected:
 #define LOG_WARNXF(fmt, data, datasz, ...)\
     LQTL_LOG_WRITE( ilardm::lib::qtlogger::QtLogger::LL_WARNING_FINE,\
                     fmt, data, datasz , ##__VA_ARGS__ )
+#else
+#define LOG_WARNXF(fmt, data, datasz, ...)\
+    LQTL_LOG_STRIPPED()
+#endif
 /** wrapper for #LOG_WARNXF
  *
  * substitudes data with NULL,
@@ -385,6 +1131,7 @@ protected:
 #define LOG_WARNF(fmt, ...)\
     LOG_WARNXF( fmt, NULL, 0 , ##__VA_ARGS__ )
 
+#if LQTL_MIN_COMPILED_LEVEL >= 3     // LL_LOG
 /** wrapper for #LQTL_LOG_WRITE
  *
  * substitudes lvl with QtLogger#LL_LOG
@@ -397,6 +1144,10 @@ protected:
 #define LOG_LOGX(fmt, data, datasz, ...)\
     LQTL_LOG_WRITE( ilardm::lib::qtlogger::QtLogger::LL_LOG,\
                     fmt, data, datasz , ##__VA_ARGS__ )
+#else
+#define LOG_LOGX(fmt, data, datasz, ...)\
+    LQTL_LOG_STRIPPED()
+#endif
 /** wrapper for #LOG_LOGX
  *
  * substitudes data with NULL,
@@ -410,6 +1161,7 @@ protected:
 #define LOG_LOG(fmt, ...)\
     LOG_LOGX( fmt, NULL, 0 , ##__VA_ARGS__ )
 
+#if LQTL_MIN_COMPILED_LEVEL >= 4     // LL_LOG_FINE
 /** wrapper for #LQTL_LOG_WRITE
  *
  * substitudes lvl with QtLogger#LL_LOG_FINE
@@ -422,6 +1174,10 @@ protected:
 #define LOG_LOGXF(fmt, data, datasz, ...)\
     LQTL_LOG_WRITE( ilardm::lib::qtlogger::QtLogger::LL_LOG_FINE,\
                     fmt, data, datasz , ##__VA_ARGS__ )
+#else
+#define LOG_LOGXF(fmt, data, datasz, ...)\
+    LQTL_LOG_STRIPPED()
+#endif
 /** wrapper for #LOG_LOGXF
  *
  * substitudes lvl with QtLogger#LL_LOG_FINE,
@@ -436,6 +1192,7 @@ protected:
 #define LOG_LOGF(fmt, ...)\
     LOG_LOGXF( fmt, NULL, 0 , ##__VA_ARGS__ )
 
+#if LQTL_MIN_COMPILED_LEVEL >= 5     // LL_DEBUG
 /** wrapper for #LQTL_LOG_WRITE
  *
  * substitudes lvl with QtLogger#LL_DEBUG
@@ -448,6 +1205,10 @@ protected:
 #define LOG_DEBUGX(fmt, data, datasz, ...)\
     LQTL_LOG_WRITE( ilardm::lib::qtlogger::QtLogger::LL_DEBUG,\
                     fmt, data, datasz , ##__VA_ARGS__ )
+#else
+#define LOG_DEBUGX(fmt, data, datasz, ...)\
+    LQTL_LOG_STRIPPED()
+#endif
 /** wrapper for #LOG_DEBUGX
  *
  * substitudes data with NULL,
@@ -461,6 +1222,7 @@ protected:
 #define LOG_DEBUG(fmt, ...)\
     LOG_DEBUGX( fmt, NULL, 0 , ##__VA_ARGS__ )
 
+#if LQTL_MIN_COMPILED_LEVEL >= 6     // LL_DEBUG_FINE
 /** wrapper for #LQTL_LOG_WRITE
  *
  * substitudes lvl with QtLogger#LL_DEBUG_FINE
@@ -473,6 +1235,10 @@ protected:
 #define LOG_DEBUGXF(fmt, data, datasz, ...)\
     LQTL_LOG_WRITE( ilardm::lib::qtlogger::QtLogger::LL_DEBUG_FINE,\
                     fmt, data, datasz , ##__VA_ARGS__ )
+#else
+#define LOG_DEBUGXF(fmt, data, datasz, ...)\
+    LQTL_LOG_STRIPPED()
+#endif
 /** wrapper for #LOG_DEBUGXF
  *
  * substitudes data with NULL,
@@ -486,6 +1252,480 @@ protected:
 #define LOG_DEBUGF(fmt, ...)\
     LOG_DEBUGXF( fmt, NULL, 0 , ##__VA_ARGS__ )
 
+/** wrapper for #LQTL_LOG_WRITE_TO
+ *
+ * substitudes lvl with QtLogger#LL_ERROR
+ *
+ * @param logger    QtLogger instance
+ * @param fmt       message format
+ * @param data      pointer to data buffer dumped in hex
+ * @param datasz    size of data buffer
+ * @param ...       arguments for fmt
+ */
+#define LOG_ERRORX_TO(logger, fmt, data, datasz, ...)\
+    LQTL_LOG_WRITE_TO( logger, ilardm::lib::qtlogger::QtLogger::LL_ERROR,\
+                       fmt, data, datasz , ##__VA_ARGS__ )
+/** wrapper for #LOG_ERRORX_TO
+ *
+ * substitudes data with NULL,
+ * datasz with 0
+ *
+ * allows invoking without arguments
+ *
+ * @param logger    QtLogger instance
+ * @param fmt       message format
+ * @param ...       arguments for fmt
+ */
+#define LOG_ERROR_TO(logger, fmt, ...)\
+    LOG_ERRORX_TO( logger, fmt, NULL, 0 , ##__VA_ARGS__ )
+
+#if LQTL_MIN_COMPILED_LEVEL >= 1     // LL_WARNING
+/** wrapper for #LQTL_LOG_WRITE_TO
+ *
+ * substitudes lvl with QtLogger#LL_WARNING
+ *
+ * @param logger    QtLogger instance
+ * @param fmt       message format
+ * @param data      pointer to data buffer dumped in hex
+ * @param datasz    size of data buffer
+ * @param ...       arguments for fmt
+ */
+#define LOG_WARNX_TO(logger, fmt, data, datasz, ...)\
+    LQTL_LOG_WRITE_TO( logger, ilardm::lib::qtlogger::QtLogger::LL_WARNING,\
+                       fmt, data, datasz , ##__VA_ARGS__ )
+#else
+#define LOG_WARNX_TO(logger, fmt, data, datasz, ...)\
+    LQTL_LOG_STRIPPED()
+#endif
+/** wrapper for #LOG_WARNX_TO
+ *
+ * substitudes data with NULL,
+ * datasz with 0
+ *
+ * allows invoking without arguments
+ *
+ * @param logger    QtLogger instance
+ * @param fmt       message format
+ * @param ...       arguments for fmt
+ */
+#define LOG_WARN_TO(logger, fmt, ...)\
+    LOG_WARNX_TO( logger, fmt, NULL, 0 , ##__VA_ARGS__ )
+
+#if LQTL_MIN_COMPILED_LEVEL >= 2     // LL_WARNING_FINE
+/** wrapper for #LQTL_LOG_WRITE_TO
+ *
+ * substitudes lvl with QtLogger#LL_WARNING_FINE
+ *
+ * @param logger    QtLogger instance
+ * @param fmt       message format
+ * @param data      pointer to data buffer dumped in hex
+ * @param datasz    size of data buffer
+ * @param ...       arguments for fmt
+ */
+#define LOG_WARNXF_TO(logger, fmt, data, datasz, ...)\
+    LQTL_LOG_WRITE_TO( logger, ilardm::lib::qtlogger::QtLogger::LL_WARNING_FINE,\
+                       fmt, data, datasz , ##__VA_ARGS__ )
+#else
+#define LOG_WARNXF_TO(logger, fmt, data, datasz, ...)\
+    LQTL_LOG_STRIPPED()
+#endif
+/** wrapper for #LOG_WARNXF_TO
+ *
+ * substitudes data with NULL,
+ * datasz with 0
+ *
+ * allows invoking without arguments
+ *
+ * @param logger    QtLogger instance
+ * @param fmt       message format
+ * @param ...       arguments for fmt
+ */
+#define LOG_WARNF_TO(logger, fmt, ...)\
+    LOG_WARNXF_TO( logger, fmt, NULL, 0 , ##__VA_ARGS__ )
+
+#if LQTL_MIN_COMPILED_LEVEL >= 3     // LL_LOG
+/** wrapper for #LQTL_LOG_WRITE_TO
+ *
+ * substitudes lvl with QtLogger#LL_LOG
+ *
+ * @param logger    QtLogger instance
+ * @param fmt       message format
+ * @param data      pointer to data buffer dumped in hex
+ * @param datasz    size of data buffer
+ * @param ...       arguments for fmt
+ */
+#define LOG_LOGX_TO(logger, fmt, data, datasz, ...)\
+    LQTL_LOG_WRITE_TO( logger, ilardm::lib::qtlogger::QtLogger::LL_LOG,\
+                       fmt, data, datasz , ##__VA_ARGS__ )
+#else
+#define LOG_LOGX_TO(logger, fmt, data, datasz, ...)\
+    LQTL_LOG_STRIPPED()
+#endif
+/** wrapper for #LOG_LOGX_TO
+ *
+ * substitudes data with NULL,
+ * datasz with 0
+ *
+ * allows invoking without arguments
+ *
+ * @param logger    QtLogger instance
+ * @param fmt       message format
+ * @param ...       arguments for fmt
+ */
+#define LOG_LOG_TO(logger, fmt, ...)\
+    LOG_LOGX_TO( logger, fmt, NULL, 0 , ##__VA_ARGS__ )
+
+#if LQTL_MIN_COMPILED_LEVEL >= 4     // LL_LOG_FINE
+/** wrapper for #LQTL_LOG_WRITE_TO
+ *
+ * substitudes lvl with QtLogger#LL_LOG_FINE
+ *
+ * @param logger    QtLogger instance
+ * @param fmt       message format
+ * @param data      pointer to data buffer dumped in hex
+ * @param datasz    size of data buffer
+ * @param ...       arguments for fmt
+ */
+#define LOG_LOGXF_TO(logger, fmt, data, datasz, ...)\
+    LQTL_LOG_WRITE_TO( logger, ilardm::lib::qtlogger::QtLogger::LL_LOG_FINE,\
+                       fmt, data, datasz , ##__VA_ARGS__ )
+#else
+#define LOG_LOGXF_TO(logger, fmt, data, datasz, ...)\
+    LQTL_LOG_STRIPPED()
+#endif
+/** wrapper for #LOG_LOGXF_TO
+ *
+ * substitudes data with NULL,
+ * datasz with 0
+ *
+ * allows invoking without arguments
+ *
+ * @param logger    QtLogger instance
+ * @param fmt       message format
+ * @param ...       arguments for fmt
+ */
+#define LOG_LOGF_TO(logger, fmt, ...)\
+    LOG_LOGXF_TO( logger, fmt, NULL, 0 , ##__VA_ARGS__ )
+
+#if LQTL_MIN_COMPILED_LEVEL >= 5     // LL_DEBUG
+/** wrapper for #LQTL_LOG_WRITE_TO
+ *
+ * substitudes lvl with QtLogger#LL_DEBUG
+ *
+ * @param logger    QtLogger instance
+ * @param fmt       message format
+ * @param data      pointer to data buffer dumped in hex
+ * @param datasz    size of data buffer
+ * @param ...       arguments for fmt
+ */
+#define LOG_DEBUGX_TO(logger, fmt, data, datasz, ...)\
+    LQTL_LOG_WRITE_TO( logger, ilardm::lib::qtlogger::QtLogger::LL_DEBUG,\
+                       fmt, data, datasz , ##__VA_ARGS__ )
+#else
+#define LOG_DEBUGX_TO(logger, fmt, data, datasz, ...)\
+    LQTL_LOG_STRIPPED()
+#endif
+/** wrapper for #LOG_DEBUGX_TO
+ *
+ * substitudes data with NULL,
+ * datasz with 0
+ *
+ * allows invoking without arguments
+ *
+ * @param logger    QtLogger instance
+ * @param fmt       message format
+ * @param ...       arguments for fmt
+ */
+#define LOG_DEBUG_TO(logger, fmt, ...)\
+    LOG_DEBUGX_TO( logger, fmt, NULL, 0 , ##__VA_ARGS__ )
+
+#if LQTL_MIN_COMPILED_LEVEL >= 6     // LL_DEBUG_FINE
+/** wrapper for #LQTL_LOG_WRITE_TO
+ *
+ * substitudes lvl with QtLogger#LL_DEBUG_FINE
+ *
+ * @param logger    QtLogger instance
+ * @param fmt       message format
+ * @param data      pointer to data buffer dumped in hex
+ * @param datasz    size of data buffer
+ * @param ...       arguments for fmt
+ */
+#define LOG_DEBUGXF_TO(logger, fmt, data, datasz, ...)\
+    LQTL_LOG_WRITE_TO( logger, ilardm::lib::qtlogger::QtLogger::LL_DEBUG_FINE,\
+                       fmt, data, datasz , ##__VA_ARGS__ )
+#else
+#define LOG_DEBUGXF_TO(logger, fmt, data, datasz, ...)\
+    LQTL_LOG_STRIPPED()
+#endif
+/** wrapper for #LOG_DEBUGXF_TO
+ *
+ * substitudes data with NULL,
+ * datasz with 0
+ *
+ * allows invoking without arguments
+ *
+ * @param logger    QtLogger instance
+ * @param fmt       message format
+ * @param ...       arguments for fmt
+ */
+#define LOG_DEBUGF_TO(logger, fmt, ...)\
+    LOG_DEBUGXF_TO( logger, fmt, NULL, 0 , ##__VA_ARGS__ )
+
+#ifdef  Q_COMPILER_VARIADIC_TEMPLATES
+/** number of '{}' placeholders in format for compile-time check
+ * in QtLogger#writeArgs, -1 if compiler unable to count it.
+ */
+#ifdef  Q_COMPILER_CONSTEXPR
+#define LQTL_COUNT_PLACEHOLDERS( fmt )\
+    ilardm::lib::qtlogger::LogArgument::countPlaceholders( fmt )
+#else
+#define LQTL_COUNT_PLACEHOLDERS( fmt )\
+    (-1)
+#endif
+
+/** type-safe wrapper for QtLogger#writeArgs.
+ *
+ * the same as #LQTL_LOG_WRITE, but fmt uses '{}' placeholders
+ * (see LogArgument) and arguments are passed without conversion
+ * (no #LQTL_QSTRINGCHAR needed for QString).
+ *
+ * @param lvl       #LOG_LEVEL
+ * @param fmt       message format
+ * @param data      pointer to data buffer dumped in hex
+ * @param datasz    size of data buffer
+ * @param ...       arguments for fmt
+ */
+#define LQTL_TLOG_WRITE(lvl, fmt, data, datasz, ... )\
+    LQTL_TLOG_WRITE_TO( ilardm::lib::qtlogger::QtLogger::getInstance(),\
+                        lvl, fmt, data, datasz , ##__VA_ARGS__ )
+
+/** #LQTL_TLOG_WRITE for given logger instance
+ *
+ * @param logger    QtLogger instance
+ * @param lvl       #LOG_LEVEL
+ * @param fmt       message format
+ * @param data      pointer to data buffer dumped in hex
+ * @param datasz    size of data buffer
+ * @param ...       arguments for fmt
+ */
+#define LQTL_TLOG_WRITE_TO(logger, lvl, fmt, data, datasz, ... )\
+    LQTL_LOG_IF_ENABLED_TO( logger, lvl,\
+        __qtLogger.writeArgs< LQTL_COUNT_PLACEHOLDERS( " " fmt ) >( lvl,\
+                                 __FILE__,\
+                                 __LINE__,\
+                                 FUNCTION_NAME,\
+                                 data, datasz,\
+                                 " " fmt ,\
+                                 ##__VA_ARGS__\
+                               ) )
+
+/** wrapper for #LQTL_TLOG_WRITE
+ *
+ * substitudes lvl with QtLogger#LL_ERROR
+ *
+ * @param fmt       message format
+ * @param data      pointer to data buffer dumped in hex
+ * @param datasz    size of data buffer
+ * @param ...       arguments for fmt
+ */
+#define TLOG_ERRORX(fmt, data, datasz, ...)\
+    LQTL_TLOG_WRITE( ilardm::lib::qtlogger::QtLogger::LL_ERROR,\
+                     fmt, data, datasz , ##__VA_ARGS__ )
+/** wrapper for #TLOG_ERRORX
+ *
+ * substitudes data with NULL,
+ * datasz with 0
+ *
+ * allows invoking without arguments
+ *
+ * @param fmt       message format
+ * @param ...       arguments for fmt
+ */
+#define TLOG_ERROR(fmt, ...)\
+    TLOG_ERRORX( fmt, NULL, 0 , ##__VA_ARGS__ )
+
+#if LQTL_MIN_COMPILED_LEVEL >= 1     // LL_WARNING
+/** wrapper for #LQTL_TLOG_WRITE
+ *
+ * substitudes lvl with QtLogger#LL_WARNING
+ *
+ * @param fmt       message format
+ * @param data      pointer to data buffer dumped in hex
+ * @param datasz    size of data buffer
+ * @param ...       arguments for fmt
+ */
+#define TLOG_WARNX(fmt, data, datasz, ...)\
+    LQTL_TLOG_WRITE( ilardm::lib::qtlogger::QtLogger::LL_WARNING,\
+                     fmt, data, datasz , ##__VA_ARGS__ )
+#else
+#define TLOG_WARNX(fmt, data, datasz, ...)\
+    LQTL_LOG_STRIPPED()
+#endif
+/** wrapper for #TLOG_WARNX
+ *
+ * substitudes data with NULL,
+ * datasz with 0
+ *
+ * allows invoking without arguments
+ *
+ * @param fmt       message format
+ * @param ...       arguments for fmt
+ */
+#define TLOG_WARN(fmt, ...)\
+    TLOG_WARNX( fmt, NULL, 0 , ##__VA_ARGS__ )
+
+#if LQTL_MIN_COMPILED_LEVEL >= 2     // LL_WARNING_FINE
+/** wrapper for #LQTL_TLOG_WRITE
+ *
+ * substitudes lvl with QtLogger#LL_WARNING_FINE
+ *
+ * @param fmt       message format
+ * @param data      pointer to data buffer dumped in hex
+ * @param datasz    size of data buffer
+ * @param ...       arguments for fmt
+ */
+#define TLOG_WARNXF(fmt, data, datasz, ...)\
+    LQTL_TLOG_WRITE( ilardm::lib::qtlogger::QtLogger::LL_WARNING_FINE,\
+                     fmt, data, datasz , ##__VA_ARGS__ )
+#else
+#define TLOG_WARNXF(fmt, data, datasz, ...)\
+    LQTL_LOG_STRIPPED()
+#endif
+/** wrapper for #TLOG_WARNXF
+ *
+ * substitudes data with NULL,
+ * datasz with 0
+ *
+ * allows invoking without arguments
+ *
+ * @param fmt       message format
+ * @param ...       arguments for fmt
+ */
+#define TLOG_WARNF(fmt, ...)\
+    TLOG_WARNXF( fmt, NULL, 0 , ##__VA_ARGS__ )
+
+#if LQTL_MIN_COMPILED_LEVEL >= 3     // LL_LOG
+/** wrapper for #LQTL_TLOG_WRITE
+ *
+ * substitudes lvl with QtLogger#LL_LOG
+ *
+ * @param fmt       message format
+ * @param data      pointer to data buffer dumped in hex
+ * @param datasz    size of data buffer
+ * @param ...       arguments for fmt
+ */
+#define TLOG_LOGX(fmt, data, datasz, ...)\
+    LQTL_TLOG_WRITE( ilardm::lib::qtlogger::QtLogger::LL_LOG,\
+                     fmt, data, datasz , ##__VA_ARGS__ )
+#else
+#define TLOG_LOGX(fmt, data, datasz, ...)\
+    LQTL_LOG_STRIPPED()
+#endif
+/** wrapper for #TLOG_LOGX
+ *
+ * substitudes data with NULL,
+ * datasz with 0
+ *
+ * allows invoking without arguments
+ *
+ * @param fmt       message format
+ * @param ...       arguments for fmt
+ */
+#define TLOG_LOG(fmt, ...)\
+    TLOG_LOGX( fmt, NULL, 0 , ##__VA_ARGS__ )
+
+#if LQTL_MIN_COMPILED_LEVEL >= 4     // LL_LOG_FINE
+/** wrapper for #LQTL_TLOG_WRITE
+ *
+ * substitudes lvl with QtLogger#LL_LOG_FINE
+ *
+ * @param fmt       message format
+ * @param data      pointer to data buffer dumped in hex
+ * @param datasz    size of data buffer
+ * @param ...       arguments for fmt
+ */
+#define TLOG_LOGXF(fmt, data, datasz, ...)\
+    LQTL_TLOG_WRITE( ilardm::lib::qtlogger::QtLogger::LL_LOG_FINE,\
+                     fmt, data, datasz , ##__VA_ARGS__ )
+#else
+#define TLOG_LOGXF(fmt, data, datasz, ...)\
+    LQTL_LOG_STRIPPED()
+#endif
+/** wrapper for #TLOG_LOGXF
+ *
+ * substitudes data with NULL,
+ * datasz with 0
+ *
+ * allows invoking without arguments
+ *
+ * @param fmt       message format
+ * @param ...       arguments for fmt
+ */
+#define TLOG_LOGF(fmt, ...)\
+    TLOG_LOGXF( fmt, NULL, 0 , ##__VA_ARGS__ )
+
+#if LQTL_MIN_COMPILED_LEVEL >= 5     // LL_DEBUG
+/** wrapper for #LQTL_TLOG_WRITE
+ *
+ * substitudes lvl with QtLogger#LL_DEBUG
+ *
+ * @param fmt       message format
+ * @param data      pointer to data buffer dumped in hex
+ * @param datasz    size of data buffer
+ * @param ...       arguments for fmt
+ */
+#define TLOG_DEBUGX(fmt, data, datasz, ...)\
+    LQTL_TLOG_WRITE( ilardm::lib::qtlogger::QtLogger::LL_DEBUG,\
+                     fmt, data, datasz , ##__VA_ARGS__ )
+#else
+#define TLOG_DEBUGX(fmt, data, datasz, ...)\
+    LQTL_LOG_STRIPPED()
+#endif
+/** wrapper for #TLOG_DEBUGX
+ *
+ * substitudes data with NULL,
+ * datasz with 0
+ *
+ * allows invoking without arguments
+ *
+ * @param fmt       message format
+ * @param ...       arguments for fmt
+ */
+#define TLOG_DEBUG(fmt, ...)\
+    TLOG_DEBUGX( fmt, NULL, 0 , ##__VA_ARGS__ )
+
+#if LQTL_MIN_COMPILED_LEVEL >= 6     // LL_DEBUG_FINE
+/** wrapper for #LQTL_TLOG_WRITE
+ *
+ * substitudes lvl with QtLogger#LL_DEBUG_FINE
+ *
+ * @param fmt       message format
+ * @param data      pointer to data buffer dumped in hex
+ * @param datasz    size of data buffer
+ * @param ...       arguments for fmt
+ */
+#define TLOG_DEBUGXF(fmt, data, datasz, ...)\
+    LQTL_TLOG_WRITE( ilardm::lib::qtlogger::QtLogger::LL_DEBUG_FINE,\
+                     fmt, data, datasz , ##__VA_ARGS__ )
+#else
+#define TLOG_DEBUGXF(fmt, data, datasz, ...)\
+    LQTL_LOG_STRIPPED()
+#endif
+/** wrapper for #TLOG_DEBUGXF
+ *
+ * substitudes data with NULL,
+ * datasz with 0
+ *
+ * allows invoking without arguments
+ *
+ * @param fmt       message format
+ * @param ...       arguments for fmt
+ */
+#define TLOG_DEBUGF(fmt, ...)\
+    TLOG_DEBUGXF( fmt, NULL, 0 , ##__VA_ARGS__ )
+
+#endif  // Q_COMPILER_VARIADIC_TEMPLATES
+
 }   // qtlogger
 }   // lib
 }   // ilardm
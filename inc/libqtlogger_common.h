@@ -53,6 +53,30 @@ namespace qtlogger {
 #define LQTL_ENABLE_LOGGER_LOGGING   (0)     // forced no debug in release
 #endif
 
+/** the most verbose log level compiled in.
+ *
+ * numeric value of QtLogger#LOG_LEVEL (0 for LL_ERROR ...
+ * 6 for LL_DEBUG_FINE). LOG_* macros for more verbose levels
+ * expand to nothing, their arguments are not evaluated.
+ * LL_ERROR messages are always compiled in.
+ *
+ * all levels compiled in by default
+ */
+#ifndef LQTL_MIN_COMPILED_LEVEL
+#define LQTL_MIN_COMPILED_LEVEL     (6)     // LL_DEBUG_FINE
+#endif
+
+/** compiler-specific printf format check attribute.
+ *
+ * @param fmtpos    position of format argument (counting implicit this)
+ * @param argpos    position of first format argument
+ */
+#ifdef  __GNUC__
+#define LQTL_PRINTF_FORMAT( fmtpos, argpos ) __attribute__(( format( printf, fmtpos, argpos ) ))
+#else
+#define LQTL_PRINTF_FORMAT( fmtpos, argpos )
+#endif
+
 #ifndef __GNUC__
 #ifdef  _MSC_VER
 #define FUNCTION_NAME           __FUNCSIG__
@@ -0,0 +1,152 @@
+// Copyright (c) 2012, Ilya Arefiev <arefiev.id@gmail.com>
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the
+//    distribution.
+//  * Neither the name of the author nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+// IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+// TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+// PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#pragma once
+
+#include    "libqtlogger_common.h"
+#include    "logrecord.h"
+
+#include    <QString>
+#include    <QByteArray>
+#include    <QChar>
+#include    <QVarLengthArray>
+
+namespace ilardm {
+namespace lib {
+namespace qtlogger {
+
+/** type-erased argument of '{}'-style log message format.
+ *
+ * constructed implicitly from integers, floating point values,
+ * booleans, pointers, C strings, QString and QByteArray.
+ * strings are referenced (not copied), so argument must not
+ * outlive the value it was constructed from.
+ *
+ * each '{}' in format substituted with the next argument,
+ * '{{' and '}}' produce '{' and '}'.
+ *
+ * @author Ilya Arefiev
+ */
+class LIBQTLOGGER_EXPORT LogArgument
+{
+public:
+    /** argument types.
+     *
+     * also used as type tags of serialized arguments
+     * (see LogArgument#serialize)
+     */
+    typedef enum {
+        AT_NONE = 0,            /**< no value */
+        AT_INTEGER = 'i',       /**< signed integer */
+        AT_UNSIGNED = 'u',      /**< unsigned integer */
+        AT_CHARACTER = 'c',     /**< single character */
+        AT_BOOLEAN = 'b',       /**< boolean */
+        AT_DOUBLE = 'd',        /**< floating point value */
+        AT_POINTER = 'p',       /**< pointer value */
+        AT_STRING = 's',        /**< 8-bit string, UTF-8 */
+        AT_UTF16 = 'w'          /**< QString data */
+    } ARGUMENT_TYPE;
+
+    /** stack buffer message is formatted into
+     */
+    typedef QVarLengthArray< QChar, 512 > FORMAT_BUFFER;
+
+public:
+    LogArgument();
+    LogArgument( bool );
+    LogArgument( char );
+    LogArgument( signed char );
+    LogArgument( unsigned char );
+    LogArgument( short );
+    LogArgument( unsigned short );
+    LogArgument( int );
+    LogArgument( unsigned int );
+    LogArgument( long );
+    LogArgument( unsigned long );
+    LogArgument( long long );
+    LogArgument( unsigned long long );
+    LogArgument( float );
+    LogArgument( double );
+    LogArgument( const void* );
+    LogArgument( const char* );
+    LogArgument( const char*, int );
+    LogArgument( const QByteArray& );
+    LogArgument( const QString& );
+    LogArgument( const QChar*, int );
+
+public:
+    static QString format( const char*, const LogArgument*, int );
+
+    void serialize( LogRecord::CAPTURE_BUFFER& ) const;
+    static const char* deserialize( const char*, const char*, LogArgument* );
+
+#ifdef  Q_COMPILER_CONSTEXPR
+    /** count '{}' placeholders in format at compile time.
+     *
+     * recursion depth equals to format length, so formats
+     * longer than compiler constexpr depth limit can not be checked.
+     *
+     * @param p format
+     *
+     * @return number of placeholders
+     */
+    static constexpr int countPlaceholders( const char* p )
+    {
+        return ( !*p ) ? 0
+             : ( p[0] == '{' && p[1] == '{' ) ? countPlaceholders( p + 2 )
+             : ( p[0] == '}' && p[1] == '}' ) ? countPlaceholders( p + 2 )
+             : ( p[0] == '{' && p[1] == '}' ) ? 1 + countPlaceholders( p + 2 )
+             : countPlaceholders( p + 1 );
+    }
+#endif
+
+protected:
+    void appendTo( FORMAT_BUFFER& ) const;
+
+protected:
+    /** argument type
+     */
+    ARGUMENT_TYPE type;
+    /** argument value
+     */
+    union {
+        qint64      integer;
+        quint64     uinteger;
+        double      real;
+        const void* pointer;
+        const char* string;
+        const QChar* utf16;
+    } value;
+    /** string length for #AT_STRING and #AT_UTF16 types
+     */
+    int length;
+};
+
+}   // qtlogger
+}   // lib
+}   // ilardm
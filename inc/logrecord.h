@@ -0,0 +1,162 @@
+// Copyright (c) 2012, Ilya Arefiev <arefiev.id@gmail.com>
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the
+//    distribution.
+//  * Neither the name of the author nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+// IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+// TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+// PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#pragma once
+
+#include    <stdarg.h>
+
+#include    "libqtlogger_common.h"
+
+#include    <QString>
+#include    <QByteArray>
+#include    <QVarLengthArray>
+
+namespace ilardm {
+namespace lib {
+namespace qtlogger {
+
+class LogArgument;
+
+/** single log message passed from call site to logger thread.
+ *
+ * holds either already formatted message text
+ * (LogRecord#message) or everything needed to format it
+ * later on logger thread: pointers to static strings
+ * (format, file name, function signature), timestamp, level,
+ * thread id and tag, raw values of format arguments
+ * (LogRecord#arguments) and copy of dumped data.
+ *
+ * on call site arguments are captured into caller's stack
+ * buffer and dumped data is referenced, both are copied
+ * only once, straight into ring (see LogRecord#serialize),
+ * so deferred formatting allocates nothing.
+ *
+ * @author Ilya Arefiev
+ */
+class LIBQTLOGGER_EXPORT LogRecord
+{
+public:
+    /** type tags of captured format arguments.
+     */
+    typedef enum {
+        AT_INTEGER = 'i',       /**< any integer stored as qint64 */
+        AT_CHARACTER = 'c',     /**< character stored as qint64 */
+        AT_DOUBLE = 'd',        /**< double */
+        AT_LONG_DOUBLE = 'D',   /**< long double */
+        AT_POINTER = 'p',       /**< pointer value */
+        AT_STRING = 's',        /**< copied string: quint32 length and characters */
+        AT_WIDE_STRING = 'w'    /**< copied UTF-16 string or character:
+                                     quint32 length and units */
+    } ARGUMENT_TYPE;
+
+    /** stack buffer format arguments are captured into
+     * (see LogRecord#captureArguments)
+     */
+    typedef QVarLengthArray< char, 512 > CAPTURE_BUFFER;
+
+public:
+    LogRecord();
+
+public:
+    void captureArguments( const char*, va_list, CAPTURE_BUFFER& );
+    void captureArguments( const char*, const LogArgument*, int, CAPTURE_BUFFER& );
+    void referenceData( const void*, size_t );
+    QString formatArguments() const;
+
+    bool isFormatted() const;
+
+    int serializedSize() const;
+    void serialize( char* ) const;
+    bool deserialize( const char*, int );
+
+    static void dumpSerialized( int, const char*, int );
+
+public:
+    /** message log level
+     */
+    int level;
+    /** message timestamp, nanoseconds since epoch
+     * (see LogTimestamp#now)
+     */
+    qint64 timestamp;
+    /** global order of message, 0 if messages are not
+     * numbered (see QtLogger#setPriorityLane)
+     */
+    quint32 sequence;
+    /** source file name (__FILE__)
+     */
+    const char* file;
+    /** source line number (__LINE__)
+     */
+    int line;
+    /** function signature (#FUNCTION_NAME)
+     */
+    const char* function;
+    /** id of thread message was logged from
+     */
+    void* threadId;
+    /** rendered thread id or name (see ProducerContext#threadTag)
+     */
+    QByteArray threadTag;
+    /** message format, must be string literal
+     */
+    const char* format;
+    /** LogRecord#format uses '{}' placeholders (see LogArgument)
+     * instead of printf-like conversions
+     */
+    bool braceFormat;
+    /** captured format arguments (see LogRecord#ARGUMENT_TYPE
+     * or LogArgument#serialize if LogRecord#braceFormat set)
+     */
+    QByteArray arguments;
+    /** copy of data to dump in hex
+     */
+    QByteArray data;
+    /** captured arguments serialized instead of LogRecord#arguments,
+     * point into capture buffer of caller, NULL if not captured
+     */
+    const char* capturedArguments;
+    /** number of LogRecord#capturedArguments bytes
+     */
+    int capturedArgumentsSize;
+    /** data serialized instead of LogRecord#data,
+     * not copied, NULL if not referenced (see LogRecord#referenceData)
+     */
+    const char* referencedData;
+    /** number of LogRecord#referencedData bytes
+     */
+    int referencedDataSize;
+    /** formatted message text, null if message should be
+     * formatted on logger thread
+     */
+    QString message;
+};
+
+}   // qtlogger
+}   // lib
+}   // ilardm
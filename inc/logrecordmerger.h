@@ -0,0 +1,97 @@
+// Copyright (c) 2012, Ilya Arefiev <arefiev.id@gmail.com>
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the
+//    distribution.
+//  * Neither the name of the author nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+// IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+// TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+// PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#pragma once
+
+#include    "libqtlogger_common.h"
+#include    "logrecord.h"
+#include    "logringbuffer.h"
+
+#include    <QList>
+
+namespace ilardm {
+namespace lib {
+namespace qtlogger {
+
+/** merges records of several rings in timestamp order.
+ *
+ * used by logger thread only. keeps one record read ahead
+ * from each ring and returns the oldest of them, so records
+ * of each ring keep their order.
+ *
+ * record is returned only if every ring has record read ahead
+ * (so no ring may have older one) or if it is older than skew
+ * window: producer which took timestamp earlier but published
+ * record later than skew window is printed out of order.
+ *
+ * barrier (see LogRecordMerger#setBarrier) tells when all records
+ * reserved in rings before it was set are returned.
+ *
+ * @author Ilya Arefiev
+ */
+class LIBQTLOGGER_EXPORT LogRecordMerger
+{
+public:
+    LogRecordMerger();
+    ~LogRecordMerger();
+
+public:
+    void addSource( LogRingBuffer*, bool );
+    bool next( LogRecord&, qint64, qint64, qint64* );
+    bool isIdle() const;
+    bool isReady() const;
+    int sourcesCount() const;
+
+    void setBarrier();
+    bool passedBarrier() const;
+
+private:
+    LogRecordMerger( const LogRecordMerger& );
+    LogRecordMerger& operator=( const LogRecordMerger& );
+
+protected:
+    /** ring merged by LogRecordMerger and its read ahead record
+     */
+    typedef struct {
+        LogRingBuffer*  ring;       /**< source ring */
+        bool            owned;      /**< ring released by merger */
+        bool            hasPending; /**< LogRecordMerger#SOURCE#pending is valid */
+        LogRecord       pending;    /**< record read ahead from ring */
+        uint            pendingAt;  /**< ring position of read ahead record */
+        bool            hasBarrier; /**< LogRecordMerger#SOURCE#barrier is valid */
+        uint            barrier;    /**< ring position of barrier */
+    } SOURCE;
+
+    /** merged rings
+     */
+    QList< SOURCE* > sources;
+};
+
+}   // qtlogger
+}   // lib
+}   // ilardm
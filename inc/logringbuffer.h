@@ -0,0 +1,142 @@
+// Copyright (c) 2012, Ilya Arefiev <arefiev.id@gmail.com>
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the
+//    distribution.
+//  * Neither the name of the author nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+// IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+// TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+// PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#pragma once
+
+#include    "libqtlogger_common.h"
+#include    "logrecord.h"
+
+#include    <QAtomicInt>
+
+namespace ilardm {
+namespace lib {
+namespace qtlogger {
+
+/** bounded lock-free multi-producer/single-consumer queue of log records.
+ *
+ * records are serialized (see LogRecord#serialize) into
+ * preallocated ring of bytes, so variable-length records take
+ * only as much space as they need.
+ *
+ * producers reserve space by advancing LogRingBuffer#tail with
+ * compare-and-swap, copy record and publish it by storing its
+ * length into record header. the only consumer reads published
+ * records in reservation order, zeroes consumed space and
+ * advances LogRingBuffer#head. record which does not fit into
+ * the rest of ring before its end is placed at ring start,
+ * the rest is marked as padding.
+ *
+ * neither producers nor consumer take locks.
+ * consumer side may be shared by several threads
+ * if they serialize LogRingBuffer#pop calls.
+ *
+ * ring may be filled less than its capacity
+ * (see LogRingBuffer#tryPush limits).
+ *
+ * ring may be owned by several objects (i.e. producer thread
+ * and logger thread for per-thread rings), the last one to
+ * call LogRingBuffer#release deletes it.
+ *
+ * all existing rings are registered in fixed-size table,
+ * so pending records of all rings may be dumped from
+ * fatal signal handler (see LogRingBuffer#dumpAll).
+ *
+ * @author Ilya Arefiev
+ */
+class LIBQTLOGGER_EXPORT LogRingBuffer
+{
+public:
+    /** default ring capacity in bytes
+     */
+    static const int DEFAULT_CAPACITY = 1 << 20;
+    /** maximum number of rings registered for LogRingBuffer#dumpAll
+     */
+    static const int MAX_REGISTERED = 256;
+
+public:
+    explicit LogRingBuffer( int = DEFAULT_CAPACITY );
+    ~LogRingBuffer();
+
+public:
+    int capacity() const;
+    int size() const;
+    bool fits( const LogRecord& ) const;
+
+    bool tryPush( const LogRecord&, int=0, int=0 );
+    bool pop( LogRecord& );
+    bool isEmpty() const;
+    bool isReady() const;
+    uint reservedPosition() const;
+    uint consumedPosition() const;
+
+    void acquire();
+    bool release();
+    bool isShared() const;
+
+    void dump( int ) const;
+    static void dumpAll( int );
+
+protected:
+    int recordSize( const LogRecord& ) const;
+    QBasicAtomicInt* headerAt( uint );
+
+private:
+    LogRingBuffer( const LogRingBuffer& );
+    LogRingBuffer& operator=( const LogRingBuffer& );
+
+protected:
+    /** ring memory, 8-byte aligned
+     */
+    char* ring;
+    /** ring size in bytes, power of 2
+     */
+    uint ringSize;
+    /** position next record will be reserved at.
+     *
+     * positions grow monotonically and wrap around 2^32,
+     * offset in ring is position & (LogRingBuffer#ringSize - 1)
+     */
+    QAtomicInt tail;
+    /** number of published not consumed records
+     */
+    QAtomicInt records;
+    /** keeps LogRingBuffer#tail and LogRingBuffer#head
+     * in different cache lines
+     */
+    char padding[ 64 - 2 * sizeof( QAtomicInt ) ];
+    /** position of the oldest not consumed record
+     */
+    QAtomicInt head;
+    /** number of ring owners (see LogRingBuffer#acquire)
+     */
+    QAtomicInt references;
+};
+
+}   // qtlogger
+}   // lib
+}   // ilardm
@@ -0,0 +1,70 @@
+// Copyright (c) 2012, Ilya Arefiev <arefiev.id@gmail.com>
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the
+//    distribution.
+//  * Neither the name of the author nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+// IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+// TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+// PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#pragma once
+
+#include    "libqtlogger_common.h"
+
+namespace ilardm {
+namespace lib {
+namespace qtlogger {
+
+/** cheap log message timestamp source.
+ *
+ * reads clock into integer at call site (LogTimestamp#now)
+ * and formats it later (LogTimestamp#format) using formatted
+ * date/time of current second cached per thread, so only
+ * fraction of second is formatted for each message.
+ *
+ * @author Ilya Arefiev
+ */
+class LIBQTLOGGER_EXPORT LogTimestamp
+{
+public:
+    /** fraction of second precision.
+     *
+     * enum value is number of digits printed
+     */
+    typedef enum {
+        TP_MILLISECONDS = 3,    /**< hh:mm:ss.zzz */
+        TP_MICROSECONDS = 6,    /**< hh:mm:ss.zzzzzz */
+        TP_NANOSECONDS = 9      /**< hh:mm:ss.zzzzzzzzz */
+    } PRECISION;
+
+    /** maximum length of formatted timestamp including terminating zero
+     */
+    static const int MAX_LENGTH = 32;
+
+public:
+    static qint64 now();
+    static int format( qint64, PRECISION, bool, char* );
+};
+
+}   // qtlogger
+}   // lib
+}   // ilardm
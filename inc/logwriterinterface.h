@@ -31,6 +31,7 @@
 #include    "libqtlogger_common.h"
 
 #include    <QString>
+#include    <QStringList>
 
 namespace ilardm {
 namespace lib {
@@ -60,6 +61,10 @@ public:
      *         false otherwise
      */
     virtual bool writeLog( QString& ) = 0;
+    virtual bool writeLogBatch( QStringList& );
+    virtual bool flush();
+    virtual bool sync();
+    virtual bool reopen();
 };
 
 }   // qtlogger
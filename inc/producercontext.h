@@ -0,0 +1,95 @@
+// Copyright (c) 2012, Ilya Arefiev <arefiev.id@gmail.com>
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the
+//    distribution.
+//  * Neither the name of the author nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+// IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+// TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+// PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#pragma once
+
+#include    "libqtlogger_common.h"
+
+#include    <QString>
+#include    <QByteArray>
+#include    <QList>
+#include    <QPair>
+
+namespace ilardm {
+namespace lib {
+namespace qtlogger {
+
+class LogRingBuffer;
+
+/** per-thread state of log message producer.
+ *
+ * created once per thread on first log message
+ * (see ProducerContext#current) and destroyed on thread exit.
+ * holds thread id, thread tag rendered once for all messages
+ * of the thread (id or name set by ProducerContext#setName)
+ * and formatting buffer reused by each message, so message
+ * prefix formatting does not allocate memory.
+ *
+ * @author Ilya Arefiev
+ */
+class LIBQTLOGGER_EXPORT ProducerContext
+{
+public:
+    /** initial size of ProducerContext#buffer
+     */
+    static const int BUFFER_SIZE = 256;
+
+public:
+    static ProducerContext* current();
+
+    ~ProducerContext();
+
+    void setName( const QString& );
+    LogRingBuffer* ring( int ) const;
+
+protected:
+    ProducerContext();
+
+public:
+    /** id of thread context belongs to
+     */
+    void* threadId;
+    /** rendered thread tag: thread name if set,
+     * thread id otherwise. shared with LogRecord#threadTag
+     */
+    QByteArray threadTag;
+    /** formatting buffer reused by each message of the thread
+     */
+    QByteArray buffer;
+    /** thread's own message rings paired with id of logger
+     * instance (see QtLogger#instanceId) each one belongs to.
+     * ring is created on first message enqueued into the instance
+     * with per-thread queue engine. shared with logger thread,
+     * which deletes it once drained if thread exits first
+     */
+    QList< QPair< int, LogRingBuffer* > > rings;
+};
+
+}   // qtlogger
+}   // lib
+}   // ilardm
@@ -0,0 +1,138 @@
+// Copyright (c) 2012, Ilya Arefiev <arefiev.id@gmail.com>
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the
+//    distribution.
+//  * Neither the name of the author nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+// IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+// TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+// PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include    <iostream>
+#include    <string>
+#include    <string.h>
+#include    <errno.h>
+
+#include    <sys/types.h>
+#include    <sys/socket.h>
+#include    <sys/un.h>
+#include    <unistd.h>
+
+/** print usage.
+ *
+ * @param name program name
+ */
+static void usage( const char* name )
+{
+    std::cerr << "usage: " << name << " {socket} {command} [{arguments}]" << std::endl
+              << "commands:" << std::endl
+              << "  list                            list modules and levels" << std::endl
+              << "  set {module} {level} [{sec}]    set module level, for a while if sec passed" << std::endl
+              << "  reset {module}                  inherit module level from parent" << std::endl
+              << "  flush [{msec}]                  write queued messages, wait up to 60000 msec" << std::endl
+              << "  rotate                          reopen log files" << std::endl
+              << "  stats                           queue and throughput statistics" << std::endl;
+}
+
+/** send command to control socket and print response.
+ *
+ * @return 0 if command succeeded<br>
+ *         1 if server responded with error<br>
+ *         2 on usage or connection error
+ */
+int main( int argc, char** argv )
+{
+    if ( argc < 3 )
+    {
+        usage( argv[0] );
+        return 2;
+    }
+
+    struct sockaddr_un address;
+    memset( &address, 0, sizeof( address ) );
+    address.sun_family = AF_UNIX;
+    if ( strlen( argv[1] ) >= sizeof( address.sun_path ) )
+    {
+        std::cerr << argv[0] << ": socket path too long" << std::endl;
+        return 2;
+    }
+    strcpy( address.sun_path, argv[1] );
+
+    std::string command;
+    for ( int i = 2; i < argc; i++ )
+    {
+        command.append( argv[i] );
+        command.append( ( i + 1 < argc ) ? " " : "\n" );
+    }
+
+    int fd = socket( AF_UNIX, SOCK_STREAM, 0 );
+    if ( fd < 0
+         || connect( fd, (struct sockaddr*)&address, sizeof( address ) ) < 0
+    ) {
+        std::cerr << argv[0] << ": unable to connect to "
+                  << argv[1] << ": " << strerror( errno ) << std::endl;
+        return 2;
+    }
+
+    const char* data = command.data();
+    size_t remaining = command.size();
+    while ( remaining > 0 )
+    {
+        ssize_t sent = write( fd, data, remaining );
+        if ( sent < 0
+             && errno == EINTR
+        ) {
+            continue;
+        }
+        if ( sent <= 0 )
+        {
+            std::cerr << argv[0] << ": unable to send command: "
+                      << strerror( errno ) << std::endl;
+            close( fd );
+            return 2;
+        }
+        data += sent;
+        remaining -= sent;
+    }
+    shutdown( fd, SHUT_WR );
+
+    std::string response;
+    char buffer[ 4096 ];
+    for ( ;; )
+    {
+        ssize_t received = read( fd, buffer, sizeof( buffer ) );
+        if ( received < 0
+             && errno == EINTR
+        ) {
+            continue;
+        }
+        if ( received <= 0 )
+        {
+            break;
+        }
+        response.append( buffer, received );
+    }
+    close( fd );
+
+    std::cout << response;
+
+    return ( response.compare( 0, 5, "ERROR" ) == 0 ? 1 : 0 );
+}
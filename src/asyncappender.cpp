@@ -0,0 +1,398 @@
+// Copyright (c) 2012, Ilya Arefiev <arefiev.id@gmail.com>
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the
+//    distribution.
+//  * Neither the name of the author nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+// IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+// TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+// PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include    <iostream>
+
+#include    "libqtlogger_common.h"
+#include    "asyncappender.h"
+#include    "logtimestamp.h"
+#include    "libqtlogger.h"
+
+using namespace ilardm::lib::qtlogger;
+
+/** asynchronous appender constructor.
+ *
+ * takes ownership of passed writer
+ * and starts delivery thread.
+ *
+ * @param logger    logger appender is added to, formats
+ *                  notice on dropped messages (see QtLogger#formatNotice)
+ * @param writer    log writer to deliver messages to
+ * @param capacity  queue capacity, messages
+ * @param policy    queue overflow policy
+ */
+AsyncAppender::AsyncAppender( QtLogger& logger, LogWriterInterface* writer, int capacity, POLICY policy )
+    : QThread(),
+      LogWriterInterface(),
+      logger( logger ),
+      writer( writer ),
+      capacity( qMax( capacity, 1 ) ),
+      policy( policy ),
+      pendingSince( 0 ),
+      deliveringSince( 0 ),
+      maxDeliveryLag( 0 ),
+      dropped( 0 ),
+      droppedReported( 0 ),
+      flushRequested( 0 ),
+      flushCompleted( 0 ),
+      syncRequested( false ),
+      stop( false )
+{
+#if LQTL_ENABLE_LOGGER_LOGGING
+    std::clog << FUNCTION_NAME
+            << " writer: "
+            << writer
+            << " capacity: "
+            << capacity
+            << " policy: "
+            << policy
+            << std::endl;
+#endif
+
+    this->start();
+}
+
+/** asynchronous appender destructor.
+ *
+ * delivers queued messages,
+ * stops delivery thread
+ * and deletes wrapped writer.
+ */
+AsyncAppender::~AsyncAppender()
+{
+#if LQTL_ENABLE_LOGGER_LOGGING
+    std::clog << FUNCTION_NAME << std::endl;
+#endif
+
+    queueMutex.lock();
+    stop = true;
+    queuedWait.wakeAll();
+    deliveredWait.wakeAll();
+    queueMutex.unlock();
+
+    this->wait();
+
+    delete writer;
+}
+
+/** log writer implementation.
+ *
+ * queues single message (see AsyncAppender#writeLogBatch).
+ *
+ * @param message log message
+ *
+ * @return true if wrapped writer is set<br>
+ *         false otherwise
+ */
+bool AsyncAppender::writeLog( QString& message )
+{
+    QStringList messages;
+    messages.append( message );
+
+    return writeLogBatch( messages );
+}
+
+/** batch log writer implementation.
+ *
+ * queues passed messages for delivery thread and wakes it up.
+ * if queue is full -- waits for delivery thread, drops new
+ * messages or drops the oldest queued ones according
+ * to AsyncAppender#policy.
+ *
+ * @param messages log messages
+ *
+ * @return true if wrapped writer is set<br>
+ *         false otherwise
+ */
+bool AsyncAppender::writeLogBatch( QStringList& messages )
+{
+    if ( !writer )
+    {
+        return false;
+    }
+
+    qint64 now = LogTimestamp::now();
+
+    queueMutex.lock();
+    for ( int i = 0; i < messages.size(); i++ )
+    {
+        if ( pending.size() >= capacity )
+        {
+            if ( policy == AP_DROP_NEWEST )
+            {
+                dropped += messages.size() - i;
+                break;
+            }
+            else if ( policy == AP_DROP_OLDEST )
+            {
+                dropOldest( pending.size() - capacity + 1 );
+            }
+            else
+            {
+                queuedWait.wakeOne();
+                while ( pending.size() >= capacity
+                        && !stop
+                ) {
+                    deliveredWait.wait( &queueMutex );
+                }
+                now = LogTimestamp::now();
+            }
+        }
+
+        if ( pending.isEmpty() )
+        {
+            pendingSince = now;
+        }
+        pending.append( messages[ i ] );
+    }
+    queuedWait.wakeOne();
+    queueMutex.unlock();
+
+    return true;
+}
+
+/** flush implementation.
+ *
+ * waits until delivery thread delivers messages queued
+ * before the call and flushes wrapped writer.
+ *
+ * @return true if wrapped writer flushed<br>
+ *         false if appender is stopping
+ */
+bool AsyncAppender::flush()
+{
+    QMutexLocker locker( &queueMutex );
+
+    int request = ++flushRequested;
+    queuedWait.wakeOne();
+
+    while ( flushCompleted - request < 0
+            && !stop
+    ) {
+        deliveredWait.wait( &queueMutex );
+    }
+
+    return ( flushCompleted - request >= 0 );
+}
+
+/** sync implementation.
+ *
+ * does not wait: asks delivery thread to sync wrapped
+ * writer (see LogWriterInterface#sync) once messages
+ * queued before the call are delivered.
+ *
+ * @return true
+ */
+bool AsyncAppender::sync()
+{
+    QMutexLocker locker( &queueMutex );
+
+    syncRequested = true;
+    queuedWait.wakeOne();
+
+    return true;
+}
+
+/** reopen implementation.
+ *
+ * waits until queued messages are delivered (see AsyncAppender#flush)
+ * and reopens wrapped writer. must be called from the thread
+ * passing messages to appender (logger thread), so delivery
+ * thread stays idle while wrapped writer is reopened.
+ *
+ * @return true if wrapped writer reopened<br>
+ *         false otherwise
+ */
+bool AsyncAppender::reopen()
+{
+    if ( !writer
+         || !flush()
+    ) {
+        return false;
+    }
+
+    return writer->reopen();
+}
+
+/** drop the oldest queued messages.
+ *
+ * AsyncAppender#queueMutex must be locked by caller.
+ *
+ * @param count number of messages to drop
+ */
+void AsyncAppender::dropOldest( int count )
+{
+    for ( int i = 0; i < count && !pending.isEmpty(); i++ )
+    {
+        pending.removeFirst();
+        dropped++;
+    }
+}
+
+/** get number of queued messages.
+ *
+ * @return number of messages waiting for delivery
+ */
+int AsyncAppender::pendingMessages()
+{
+    QMutexLocker locker( &queueMutex );
+
+    return pending.size();
+}
+
+/** get number of dropped messages.
+ *
+ * @return number of messages dropped since appender creation
+ */
+int AsyncAppender::droppedMessages()
+{
+    QMutexLocker locker( &queueMutex );
+
+    return dropped;
+}
+
+/** get current delivery lag.
+ *
+ * @return time the oldest not delivered message waits, milliseconds
+ */
+qint64 AsyncAppender::lag()
+{
+    QMutexLocker locker( &queueMutex );
+
+    qint64 since = deliveringSince;
+    if ( !since
+         && !pending.isEmpty()
+    ) {
+        since = pendingSince;
+    }
+
+    return ( since ? ( LogTimestamp::now() - since ) / 1000000 : 0 );
+}
+
+/** get the largest delivery lag.
+ *
+ * @return the longest time message waited for delivery, milliseconds
+ */
+qint64 AsyncAppender::maxLag()
+{
+    QMutexLocker locker( &queueMutex );
+
+    return maxDeliveryLag / 1000000;
+}
+
+/** delivery thread.
+ *
+ * waits for queued messages, takes all of them at once,
+ * passes them to wrapped writer (see LogWriterInterface#writeLogBatch)
+ * followed by number of messages dropped since previous delivery
+ * (formatted by QtLogger#formatNotice of AsyncAppender#logger),
+ * and updates lag metrics.
+ *
+ * once queue is empty serves flush and sync requests
+ * (see AsyncAppender#flush and AsyncAppender#sync).
+ *
+ * on stop delivers queued messages before exit.
+ */
+void AsyncAppender::run()
+{
+#if LQTL_ENABLE_LOGGER_LOGGING
+    std::clog << FUNCTION_NAME
+            << " start"
+            << std::endl;
+#endif
+
+    QStringList batch;
+
+    queueMutex.lock();
+    for ( ;; )
+    {
+        while ( pending.isEmpty()
+                && flushRequested == flushCompleted
+                && !syncRequested
+                && !stop
+        ) {
+            queuedWait.wait( &queueMutex );
+        }
+        if ( pending.isEmpty()
+             && flushRequested != flushCompleted
+        ) {
+            int request = flushRequested;
+            queueMutex.unlock();
+
+            writer->flush();
+
+            queueMutex.lock();
+            flushCompleted = request;
+            deliveredWait.wakeAll();
+            continue;
+        }
+        if ( pending.isEmpty()
+             && syncRequested
+        ) {
+            syncRequested = false;
+            queueMutex.unlock();
+
+            writer->sync();
+
+            queueMutex.lock();
+            continue;
+        }
+        if ( pending.isEmpty() )
+        {
+            break;
+        }
+
+        batch = pending;
+        pending.clear();
+        deliveringSince = pendingSince;
+        int newlyDropped = dropped - droppedReported;
+        droppedReported = dropped;
+        deliveredWait.wakeAll();
+        queueMutex.unlock();
+
+        if ( newlyDropped > 0 )
+        {
+            QString notice = QString( " %1 messages dropped by asynchronous appender" )
+                                .arg( newlyDropped );
+            batch.append( logger.formatNotice( QtLogger::LL_WARNING, notice ) );
+        }
+        writer->writeLogBatch( batch );
+        batch.clear();
+
+        queueMutex.lock();
+        maxDeliveryLag = qMax( maxDeliveryLag, LogTimestamp::now() - deliveringSince );
+        deliveringSince = 0;
+    }
+    queueMutex.unlock();
+
+#if LQTL_ENABLE_LOGGER_LOGGING
+    std::clog << FUNCTION_NAME
+            << " end"
+            << std::endl;
+#endif
+}
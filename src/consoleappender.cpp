@@ -70,3 +70,43 @@ bool ConsoleAppender::writeLog( QString& message )
 
     return true;
 }
+
+/** batch write log implemenmtation.
+ *
+ * appends all passed log messages to C++ std::clog
+ * and flushes it once
+ *
+ * @param messages log messages
+ *
+ * @return currently true only
+ */
+bool ConsoleAppender::writeLogBatch( QStringList& messages )
+{
+#if LQTL_ENABLE_LOGGER_LOGGING
+    std::clog << FUNCTION_NAME
+            << " messages: "
+            << messages.size()
+            << std::endl;
+#endif
+
+    for ( int i = 0; i < messages.size(); i++ )
+    {
+        std::clog << messages[ i ].toStdString() << '\n';
+    }
+    std::clog.flush();
+
+    return true;
+}
+
+/** flush implemenmtation.
+ *
+ * flushes C++ std::clog
+ *
+ * @return currently true only
+ */
+bool ConsoleAppender::flush()
+{
+    std::clog.flush();
+
+    return true;
+}
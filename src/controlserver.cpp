@@ -0,0 +1,611 @@
+// Copyright (c) 2012, Ilya Arefiev <arefiev.id@gmail.com>
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the
+//    distribution.
+//  * Neither the name of the author nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+// IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+// TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+// PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include    <iostream>
+#include    <stdio.h>
+#include    <stdlib.h>
+#include    <string.h>
+#include    <errno.h>
+
+#include    <QFile>
+#include    <QMap>
+#include    <QMapIterator>
+
+#include    "libqtlogger_common.h"
+#include    "controlserver.h"
+#include    "libqtlogger.h"
+
+// platform headers depend on Q_OS_* defines
+#if defined ( Q_OS_UNIX )
+#include    <sys/types.h>
+#include    <sys/socket.h>
+#include    <sys/stat.h>
+#include    <sys/un.h>
+#include    <poll.h>
+#include    <fcntl.h>
+#include    <unistd.h>
+#endif
+
+using namespace ilardm::lib::qtlogger;
+
+/** control server constructor.
+ *
+ * removes stale socket left by previous run (if any),
+ * creates listening socket accessible by owner only
+ * and starts server thread.
+ *
+ * existing socket is replaced only if nobody accepts
+ * connections on it, so another running server is never
+ * hijacked. socket is bound in private (0700) directory
+ * created next to socket path, made accessible by owner only
+ * and then renamed to socket path, so there is no window
+ * others may connect in. process umask is not touched,
+ * so files created by other threads are not affected.
+ *
+ * @param logger    controlled logger
+ * @param path      socket path
+ */
+ControlServer::ControlServer( QtLogger& logger, const QString& path )
+    : QThread(),
+      logger( logger ),
+      path( QFile::encodeName( path ) ),
+      listenFd( -1 ),
+      stop( false )
+{
+#if LQTL_ENABLE_LOGGER_LOGGING
+    std::clog << FUNCTION_NAME
+            << " path: "
+            << this->path.constData()
+            << std::endl;
+#endif
+
+#if defined ( Q_OS_UNIX )
+    struct sockaddr_un address;
+    memset( &address, 0, sizeof( address ) );
+    address.sun_family = AF_UNIX;
+
+    if ( this->path.isEmpty()
+         || this->path.size() >= (int)sizeof( address.sun_path )
+    ) {
+#if LQTL_ENABLE_LOGGER_LOGGING
+        std::cerr << FUNCTION_NAME
+                << " invalid socket path"
+                << std::endl;
+#endif
+        return;
+    }
+    memcpy( address.sun_path, this->path.constData(), this->path.size() );
+
+    // private directory and socket in it: "{path}.XXXXXX/s"
+    QByteArray directory = this->path + ".XXXXXX";
+    if ( directory.size() + 2 >= (int)sizeof( address.sun_path ) )
+    {
+#if LQTL_ENABLE_LOGGER_LOGGING
+        std::cerr << FUNCTION_NAME
+                << " socket path too long"
+                << std::endl;
+#endif
+        return;
+    }
+
+    struct stat info;
+    if ( lstat( this->path.constData(), &info ) == 0 )
+    {
+        if ( !S_ISSOCK( info.st_mode ) )
+        {
+#if LQTL_ENABLE_LOGGER_LOGGING
+            std::cerr << FUNCTION_NAME
+                    << " path exists and is not socket"
+                    << std::endl;
+#endif
+            return;
+        }
+
+        int probe = socket( AF_UNIX, SOCK_STREAM, 0 );
+        if ( probe < 0 )
+        {
+#if LQTL_ENABLE_LOGGER_LOGGING
+            std::cerr << FUNCTION_NAME
+                    << " unable to create socket: "
+                    << strerror( errno )
+                    << std::endl;
+#endif
+            return;
+        }
+
+        int connected = ::connect( probe, (struct sockaddr*)&address, sizeof( address ) );
+        int error = errno;
+        ::close( probe );
+
+        if ( connected == 0 )
+        {
+#if LQTL_ENABLE_LOGGER_LOGGING
+            std::cerr << FUNCTION_NAME
+                    << " socket is in use by another server"
+                    << std::endl;
+#endif
+            return;
+        }
+
+        // stale socket is replaced by rename below
+        if ( error != ECONNREFUSED )
+        {
+#if LQTL_ENABLE_LOGGER_LOGGING
+            std::cerr << FUNCTION_NAME
+                    << " unable to probe socket: "
+                    << strerror( error )
+                    << std::endl;
+#endif
+            return;
+        }
+    }
+
+    if ( !mkdtemp( directory.data() ) )
+    {
+#if LQTL_ENABLE_LOGGER_LOGGING
+        std::cerr << FUNCTION_NAME
+                << " unable to create directory: "
+                << strerror( errno )
+                << std::endl;
+#endif
+        return;
+    }
+    QByteArray temporary = directory + "/s";
+
+    struct sockaddr_un temporaryAddress;
+    memset( &temporaryAddress, 0, sizeof( temporaryAddress ) );
+    temporaryAddress.sun_family = AF_UNIX;
+    memcpy( temporaryAddress.sun_path, temporary.constData(), temporary.size() );
+
+    int fd = socket( AF_UNIX, SOCK_STREAM, 0 );
+    if ( fd < 0 )
+    {
+#if LQTL_ENABLE_LOGGER_LOGGING
+        std::cerr << FUNCTION_NAME
+                << " unable to create socket: "
+                << strerror( errno )
+                << std::endl;
+#endif
+        ::rmdir( directory.constData() );
+        return;
+    }
+    fcntl( fd, F_SETFD, FD_CLOEXEC );
+
+    bool renamed = ( bind( fd, (struct sockaddr*)&temporaryAddress, sizeof( temporaryAddress ) ) == 0
+                     && chmod( temporary.constData(), S_IRUSR | S_IWUSR ) == 0
+                     && ::rename( temporary.constData(), this->path.constData() ) == 0 );
+    if ( !renamed
+         || listen( fd, 4 ) < 0
+    ) {
+#if LQTL_ENABLE_LOGGER_LOGGING
+        std::cerr << FUNCTION_NAME
+                << " unable to listen: "
+                << strerror( errno )
+                << std::endl;
+#endif
+        ::close( fd );
+        ::unlink( ( renamed ? this->path : temporary ).constData() );
+        ::rmdir( directory.constData() );
+        return;
+    }
+    ::rmdir( directory.constData() );
+
+    listenFd = fd;
+    this->start();
+#endif
+}
+
+/** control server destructor.
+ *
+ * stops server thread, removes socket
+ * and restores levels set for a while.
+ */
+ControlServer::~ControlServer()
+{
+#if LQTL_ENABLE_LOGGER_LOGGING
+    std::clog << FUNCTION_NAME << std::endl;
+#endif
+
+    stop = true;
+    this->wait();
+
+#if defined ( Q_OS_UNIX )
+    if ( listenFd >= 0 )
+    {
+        ::close( listenFd );
+        ::unlink( path.constData() );
+    }
+#endif
+
+    restoreLevels( true );
+}
+
+/** check whether server accepts connections.
+ *
+ * @return true if socket created and server thread started<br>
+ *         false otherwise
+ */
+bool ControlServer::isListening() const
+{
+    return ( listenFd >= 0 );
+}
+
+/** server thread.
+ *
+ * polls listening socket, serves clients one by one
+ * (see ControlServer#serveClient) and restores expired
+ * levels (see ControlServer#restoreLevels).
+ */
+void ControlServer::run()
+{
+#if defined ( Q_OS_UNIX )
+    while ( !stop )
+    {
+        struct pollfd descriptor;
+        descriptor.fd = listenFd;
+        descriptor.events = POLLIN;
+        descriptor.revents = 0;
+
+        int ready = poll( &descriptor, 1, POLL_INTERVAL );
+
+        restoreLevels( false );
+
+        if ( ready <= 0 )
+        {
+            continue;
+        }
+
+        int client = accept( listenFd, NULL, NULL );
+        if ( client < 0 )
+        {
+            continue;
+        }
+
+        serveClient( client );
+        ::close( client );
+    }
+#endif
+}
+
+/** read command from client, execute it and send response.
+ *
+ * command is terminated by new line or end of stream.
+ * client not sending anything for ControlServer#CLIENT_TIMEOUT
+ * is dropped.
+ *
+ * @param client connected socket
+ */
+void ControlServer::serveClient( int client )
+{
+#if defined ( Q_OS_UNIX )
+    QByteArray command;
+    char buffer[ 256 ];
+
+    while ( command.size() < MAX_COMMAND
+            && !command.contains( '\n' )
+    ) {
+        struct pollfd descriptor;
+        descriptor.fd = client;
+        descriptor.events = POLLIN;
+        descriptor.revents = 0;
+
+        if ( poll( &descriptor, 1, CLIENT_TIMEOUT ) <= 0 )
+        {
+            return;
+        }
+
+        ssize_t received = recv( client, buffer, sizeof( buffer ), 0 );
+        if ( received < 0
+             && errno == EINTR
+        ) {
+            continue;
+        }
+        if ( received <= 0 )
+        {
+            break;
+        }
+        command.append( buffer, (int)received );
+    }
+
+    int end = command.indexOf( '\n' );
+    QByteArray response = execute( QString::fromUtf8( command.constData(),
+                                                      ( end >= 0 ? end : command.size() ) ) );
+
+    int flags = 0;
+#ifdef  MSG_NOSIGNAL
+    flags = MSG_NOSIGNAL;
+#endif
+    const char* data = response.constData();
+    int remaining = response.size();
+    while ( remaining > 0 )
+    {
+        ssize_t sent = send( client, data, remaining, flags );
+        if ( sent < 0
+             && errno == EINTR
+        ) {
+            continue;
+        }
+        if ( sent <= 0 )
+        {
+            break;
+        }
+        data += sent;
+        remaining -= (int)sent;
+    }
+#else
+    LQTL_UNUSED_VARIABLE( client );
+#endif
+}
+
+/** execute control command.
+ *
+ * see ControlServer for commands description.
+ *
+ * @param command command line without new line
+ *
+ * @return response text
+ */
+QByteArray ControlServer::execute( const QString& command )
+{
+#if LQTL_ENABLE_LOGGER_LOGGING
+    std::clog << FUNCTION_NAME
+            << " command: "
+            << command.toStdString()
+            << std::endl;
+#endif
+
+    QStringList args = command.trimmed().split( QChar( ' ' ), QString::SkipEmptyParts );
+    if ( args.isEmpty() )
+    {
+        return "ERROR empty command\n";
+    }
+
+    QString name = args.at( 0 ).toLower();
+    if ( name == "list" )
+    {
+        return listModules();
+    }
+    else if ( name == "set" )
+    {
+        return setLevel( args );
+    }
+    else if ( name == "reset"
+              && args.size() == 2
+    ) {
+        for ( int i = 0; i < temporaryLevels.size(); i++ )
+        {
+            if ( temporaryLevels[ i ].module == args.at( 1 ) )
+            {
+                temporaryLevels.removeAt( i );
+                break;
+            }
+        }
+
+        return ( logger.resetModuleLevel( args.at( 1 ) ) ? "OK\n" : "ERROR unknown module\n" );
+    }
+    else if ( name == "flush" )
+    {
+        bool ok = true;
+        int timeout = ( args.size() > 1 ? args.at( 1 ).toInt( &ok ) : CLIENT_TIMEOUT * 5 );
+        if ( !ok
+             || timeout < 0
+        ) {
+            return "ERROR invalid timeout\n";
+        }
+
+        // client must not block server thread forever
+        if ( timeout > MAX_FLUSH_TIMEOUT )
+        {
+            timeout = MAX_FLUSH_TIMEOUT;
+        }
+
+        return ( logger.flush( timeout ) ? "OK\n" : "ERROR timeout\n" );
+    }
+    else if ( name == "rotate" )
+    {
+        logger.reopenWriters();
+
+        return ( logger.flush( CLIENT_TIMEOUT * 5 ) ? "OK\n" : "ERROR timeout\n" );
+    }
+    else if ( name == "stats" )
+    {
+        QByteArray response;
+        QMapIterator< QString, qint64 > iter( logger.getStatistics() );
+        while ( iter.hasNext() )
+        {
+            iter.next();
+            response.append( QString( "%1 %2\n" )
+                                .arg( iter.key() )
+                                .arg( iter.value() )
+                                .toUtf8() );
+        }
+
+        return response;
+    }
+
+    return "ERROR unknown command\n";
+}
+
+/** list known modules.
+ *
+ * @return line per module: name, level and "final" or
+ *         "inherited" flag if set, separated by tab
+ */
+QByteArray ControlServer::listModules()
+{
+    QByteArray response;
+
+    QMap< QString, QtLogger::MODULE_LEVEL > modules = logger.getModulesMap();
+    QMapIterator< QString, QtLogger::MODULE_LEVEL > iter( modules );
+    while ( iter.hasNext() )
+    {
+        iter.next();
+
+        const QtLogger::MODULE_LEVEL& mlvl = iter.value();
+        response.append( QString( "%1\t%2\t%3\n" )
+                            .arg( iter.key() )
+                            .arg( logger.describeLogLevel( mlvl.level ).trimmed() )
+                            .arg( mlvl.inherited ? "inherited" : ( mlvl.final ? "final" : "" ) )
+                            .toUtf8() );
+    }
+
+    return response;
+}
+
+/** execute "set" command.
+ *
+ * if time passed, remembers level module had before
+ * the first of subsequent temporary changes, so
+ * it is restored once the last change expires.
+ *
+ * @param args command arguments: "set", module, level, optional seconds
+ *
+ * @return response text
+ */
+QByteArray ControlServer::setLevel( const QStringList& args )
+{
+    if ( args.size() < 3
+         || args.size() > 4
+    ) {
+        return "ERROR usage: set {module} {level} [{seconds}]\n";
+    }
+
+    const QString& module = args.at( 1 );
+
+    int level = parseLevel( args.at( 2 ) );
+    if ( level < 0 )
+    {
+        return "ERROR invalid level\n";
+    }
+
+    int seconds = 0;
+    if ( args.size() == 4 )
+    {
+        bool ok = false;
+        seconds = args.at( 3 ).toInt( &ok );
+        if ( !ok
+             || seconds <= 0
+        ) {
+            return "ERROR invalid time\n";
+        }
+    }
+
+    QtLogger::MODULE_LEVEL mlvl = logger.getModuleLevel( module );
+    int previous = ( ( mlvl.level != QtLogger::LL_STUB && !mlvl.inherited ) ? (int)mlvl.level : -1 );
+
+    for ( int i = 0; i < temporaryLevels.size(); i++ )
+    {
+        if ( temporaryLevels[ i ].module == module )
+        {
+            previous = temporaryLevels[ i ].level;
+            temporaryLevels.removeAt( i );
+            break;
+        }
+    }
+
+    logger.setModuleLevel( module, (QtLogger::LOG_LEVEL)level, true );
+
+    if ( seconds > 0 )
+    {
+        TEMPORARY_LEVEL temporary;
+        temporary.module = module;
+        temporary.level = previous;
+        temporary.expires = LogTimestamp::now() + (qint64)seconds * 1000000000;
+        temporaryLevels.append( temporary );
+    }
+
+    return "OK\n";
+}
+
+/** restore levels set for a while by "set" command.
+ *
+ * @param all restore all levels, not only expired ones
+ */
+void ControlServer::restoreLevels( bool all )
+{
+    qint64 now = LogTimestamp::now();
+
+    for ( int i = 0; i < temporaryLevels.size(); )
+    {
+        const TEMPORARY_LEVEL& temporary = temporaryLevels.at( i );
+        if ( !all
+             && temporary.expires > now
+        ) {
+            i++;
+            continue;
+        }
+
+#if LQTL_ENABLE_LOGGER_LOGGING
+        std::clog << FUNCTION_NAME
+                << " module: "
+                << temporary.module.toStdString()
+                << " level: "
+                << temporary.level
+                << std::endl;
+#endif
+
+        if ( temporary.level < 0 )
+        {
+            logger.resetModuleLevel( temporary.module );
+        }
+        else
+        {
+            logger.setModuleLevel( temporary.module, (QtLogger::LOG_LEVEL)temporary.level, true );
+        }
+        temporaryLevels.removeAt( i );
+    }
+}
+
+/** parse log level.
+ *
+ * @param text level number or description
+ *             (see QtLogger#getLogLevelsDescription), case insensitive
+ *
+ * @return #LOG_LEVEL value<br>
+ *         or -1 if text is not a level
+ */
+int ControlServer::parseLevel( const QString& text )
+{
+    bool ok = false;
+    int level = text.toInt( &ok );
+    if ( ok )
+    {
+        return ( ( level >= 0 && level < QtLogger::LL_STUB ) ? level : -1 );
+    }
+
+    QStringList levels = logger.getLogLevelsDescription();
+    for ( int i = 0; i < levels.size() && i < QtLogger::LL_STUB; i++ )
+    {
+        if ( levels.at( i ).trimmed().compare( text, Qt::CaseInsensitive ) == 0 )
+        {
+            return i;
+        }
+    }
+
+    return -1;
+}
@@ -0,0 +1,219 @@
+// Copyright (c) 2012, Ilya Arefiev <arefiev.id@gmail.com>
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the
+//    distribution.
+//  * Neither the name of the author nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+// IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+// TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+// PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include    <iostream>
+#include    <string.h>
+#include    <errno.h>
+
+#include    <QFile>
+
+#include    "libqtlogger_common.h"
+#include    "crashhandler.h"
+#include    "logringbuffer.h"
+
+// platform headers depend on Q_OS_* defines
+#if defined ( Q_OS_UNIX )
+#include    <signal.h>
+#include    <fcntl.h>
+#include    <unistd.h>
+#endif
+
+using namespace ilardm::lib::qtlogger;
+
+#if defined ( Q_OS_UNIX )
+
+/** handled signals
+ */
+static const int crashSignals[] = { SIGSEGV, SIGBUS, SIGILL, SIGFPE, SIGABRT };
+/** number of handled signals
+ */
+#define LQTL_CRASH_SIGNALS  ( (int)( sizeof( crashSignals ) / sizeof( crashSignals[0] ) ) )
+
+/** file descriptor records are dumped to, -1 if not installed
+ */
+static volatile sig_atomic_t crashFd = -1;
+/** crash handler already running flag
+ */
+static volatile sig_atomic_t crashHandling = 0;
+/** actions installed before CrashHandler#install
+ */
+static struct sigaction previousActions[ LQTL_CRASH_SIGNALS ];
+/** alternate stack of installing thread, to handle stack overflow
+ */
+static char crashStack[ 64 * 1024 ];
+
+#endif
+
+/** install crash handler writing to file.
+ *
+ * opens file for appending right now, so nothing
+ * has to be allocated when crash happens.
+ *
+ * @param path file to write pending records to
+ *
+ * @return true if handler installed<br>
+ *         false if file can not be opened or platform is not supported
+ */
+bool CrashHandler::install( const QString& path )
+{
+#if LQTL_ENABLE_LOGGER_LOGGING
+    std::clog << FUNCTION_NAME
+            << " path: "
+            << path.toStdString()
+            << std::endl;
+#endif
+
+#if defined ( Q_OS_UNIX )
+    int fd = ::open( QFile::encodeName( path ).constData(),
+                     O_WRONLY | O_CREAT | O_APPEND,
+                     0644 );
+    if ( fd < 0 )
+    {
+#if LQTL_ENABLE_LOGGER_LOGGING
+        std::cerr << FUNCTION_NAME
+                << " unable to open file: "
+                << strerror( errno )
+                << std::endl;
+#endif
+        return false;
+    }
+
+    return install( fd );
+#else
+    (void)path;
+    return false;
+#endif
+}
+
+/** install crash handler writing to file descriptor.
+ *
+ * replaces previously installed descriptor, which
+ * is not closed.
+ *
+ * @param fd opened file descriptor (i.e. STDERR_FILENO)
+ *
+ * @return true if handler installed<br>
+ *         false if platform is not supported
+ */
+bool CrashHandler::install( int fd )
+{
+#if defined ( Q_OS_UNIX )
+    bool installed = ( crashFd >= 0 );
+    crashFd = fd;
+
+    if ( installed )
+    {
+        return true;
+    }
+
+    stack_t stack;
+    memset( &stack, 0, sizeof( stack ) );
+    stack.ss_sp = crashStack;
+    stack.ss_size = sizeof( crashStack );
+    sigaltstack( &stack, NULL );
+
+    struct sigaction action;
+    memset( &action, 0, sizeof( action ) );
+    action.sa_handler = &CrashHandler::handleSignal;
+    action.sa_flags = SA_ONSTACK;
+    sigemptyset( &action.sa_mask );
+
+    for ( int i = 0; i < LQTL_CRASH_SIGNALS; i++ )
+    {
+        sigaction( crashSignals[ i ], &action, &previousActions[ i ] );
+    }
+
+    return true;
+#else
+    (void)fd;
+    return false;
+#endif
+}
+
+/** uninstall crash handler.
+ *
+ * restores previous signal actions,
+ * file descriptor is not closed.
+ */
+void CrashHandler::uninstall()
+{
+#if defined ( Q_OS_UNIX )
+    if ( crashFd < 0 )
+    {
+        return;
+    }
+
+    for ( int i = 0; i < LQTL_CRASH_SIGNALS; i++ )
+    {
+        sigaction( crashSignals[ i ], &previousActions[ i ], NULL );
+    }
+    crashFd = -1;
+#endif
+}
+
+/** fatal signal handler.
+ *
+ * async-signal-safe: writes banner and pending records
+ * (see LogRingBuffer#dumpAll) to installed descriptor,
+ * syncs it, restores previous action and raises signal again.
+ *
+ * @param signo signal number
+ */
+void CrashHandler::handleSignal( int signo )
+{
+#if defined ( Q_OS_UNIX )
+    int fd = crashFd;
+
+    if ( !crashHandling
+         && fd >= 0
+    ) {
+        crashHandling = 1;
+
+        char banner[] = "\n=== pending log records on fatal signal 00 ===\n";
+        char* digits = strstr( banner, "00" );
+        digits[0] = (char)( '0' + ( signo / 10 ) % 10 );
+        digits[1] = (char)( '0' + signo % 10 );
+        if ( ::write( fd, banner, sizeof( banner ) - 1 ) >= 0 )
+        {
+            LogRingBuffer::dumpAll( fd );
+        }
+        fsync( fd );
+    }
+
+    for ( int i = 0; i < LQTL_CRASH_SIGNALS; i++ )
+    {
+        if ( crashSignals[ i ] == signo )
+        {
+            sigaction( signo, &previousActions[ i ], NULL );
+        }
+    }
+    raise( signo );
+#else
+    (void)signo;
+#endif
+}
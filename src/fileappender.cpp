@@ -32,6 +32,7 @@
 
 #include    "libqtlogger_common.h"
 #include    "fileappender.h"
+#include    "logtimestamp.h"
 
 using namespace ilardm::lib::qtlogger;
 
@@ -41,49 +42,36 @@ using namespace ilardm::lib::qtlogger;
  * stream from file
  * and set FileAppender#valid flag if no
  * error occured
+ *
+ * @param filename      log file name
+ * @param bufferSize    flush once that many bytes pending,
+ *                      0 to flush after each write
+ * @param flushInterval flush once the oldest pending message
+ *                      waits that many milliseconds, 0 to not limit
  */
-FileAppender::FileAppender( QString filename )
+FileAppender::FileAppender( QString filename, int bufferSize, int flushInterval )
     : LogWriterInterface(),
       logfile( filename ),
       lfStream( &logfile ),
-      valid( false )
+      valid( false ),
+      bufferSize( qMax( bufferSize, 0 ) ),
+      flushInterval( qMax( flushInterval, 0 ) ),
+      pendingBytes( 0 ),
+      pendingSince( 0 )
 {
 #if LQTL_ENABLE_LOGGER_LOGGING
     std::clog << FUNCTION_NAME
             << " filename: "
             << filename.toStdString()
+            << " buffer: "
+            << bufferSize
+            << " interval: "
+            << flushInterval
             << std::endl;
 #endif
 
-    bool status = logfile.open( QIODevice::Append
-                                | QIODevice::Text
-                              );
-
-    if ( status )
-    {
-        if ( lfStream.status() == QTextStream::Ok )
-        {
-            valid = true;
-        }
-        else
-        {
-#if LQTL_ENABLE_LOGGER_LOGGING
-            std::cerr << FUNCTION_NAME
-                    << " unable to create text stream: "
-                    << lfStream.status()
-                    << std::endl;
-#endif
-            return;
-        }
-    }
-    else
+    if ( !open() )
     {
-#if LQTL_ENABLE_LOGGER_LOGGING
-        std::cerr << FUNCTION_NAME
-                << " unable to open file: "
-                << logfile.error()
-                << std::endl;
-#endif
         return;
     }
 
@@ -128,7 +116,7 @@ FileAppender::~FileAppender()
 /** log writer implementation
  *
  * appends stream with passed log message and
- * flushes stream
+ * flushes stream if due (see FileAppender#flushIfDue)
  *
  * @param message log message
  *
@@ -143,8 +131,75 @@ bool FileAppender::writeLog( QString& message )
 
     if ( valid )
     {
+        if ( pendingBytes == 0 )
+        {
+            pendingSince = LogTimestamp::now();
+        }
         lfStream << message << "\n";
+        pendingBytes += encodedSize( message ) + 1;
+
+        return flushIfDue();
+    }
+
+    return false;
+}
+
+/** batch log writer implementation
+ *
+ * appends stream with all passed log messages and
+ * flushes stream once if due (see FileAppender#flushIfDue)
+ *
+ * @param messages log messages
+ *
+ * @return true if FileAppender#valid is set<br>
+ *         false otherwise
+ */
+bool FileAppender::writeLogBatch( QStringList& messages )
+{
+#if LQTL_ENABLE_LOGGER_LOGGING
+    std::clog << FUNCTION_NAME
+            << " messages: "
+            << messages.size()
+            << std::endl;
+#endif
+
+    if ( valid )
+    {
+        if ( pendingBytes == 0
+             && !messages.isEmpty()
+        ) {
+            pendingSince = LogTimestamp::now();
+        }
+        for ( int i = 0; i < messages.size(); i++ )
+        {
+            lfStream << messages[ i ] << "\n";
+            pendingBytes += encodedSize( messages[ i ] ) + 1;
+        }
+
+        return flushIfDue();
+    }
+
+    return false;
+}
+
+
+/** flush implementation
+ *
+ * flushes stream
+ *
+ * @return true if FileAppender#valid is set<br>
+ *         false otherwise
+ */
+bool FileAppender::flush()
+{
+#if LQTL_ENABLE_LOGGER_LOGGING
+    std::clog << FUNCTION_NAME << std::endl;
+#endif
+
+    if ( valid )
+    {
         lfStream.flush();
+        pendingBytes = 0;
 
         return true;
     }
@@ -152,3 +207,151 @@ bool FileAppender::writeLog( QString& message )
     return false;
 }
 
+/** sync implementation
+ *
+ * flushes stream if any message pending
+ *
+ * @return true if FileAppender#valid is set<br>
+ *         false otherwise
+ */
+bool FileAppender::sync()
+{
+    if ( valid
+         && pendingBytes > 0
+    ) {
+        return flush();
+    }
+
+    return valid;
+}
+
+/** get number of bytes message takes in file.
+ *
+ * for UTF-8 (the usual locale codec) size is counted
+ * without encoding message, messages are encoded by
+ * other codecs.
+ *
+ * @param message log message
+ *
+ * @return size of message encoded by stream codec, bytes
+ */
+int FileAppender::encodedSize( const QString& message )
+{
+    QTextCodec* codec = lfStream.codec();
+    if ( codec
+         && codec->mibEnum() != UTF8_MIB
+    ) {
+        return codec->fromUnicode( message ).size();
+    }
+
+    int size = 0;
+    const ushort* data = message.utf16();
+    for ( int i = 0; i < message.size(); i++ )
+    {
+        ushort c = data[ i ];
+        if ( c < 0x80 )
+        {
+            size += 1;
+        }
+        else if ( c < 0x800
+                  || ( c >= 0xd800 && c <= 0xdfff )
+        ) {
+            // surrogate pair takes 4 bytes
+            size += 2;
+        }
+        else
+        {
+            size += 3;
+        }
+    }
+
+    return size;
+}
+
+/** flush stream if pending messages reached
+ * FileAppender#bufferSize or the oldest of them
+ * waits longer than FileAppender#flushInterval
+ *
+ * @return true if FileAppender#valid is set<br>
+ *         false otherwise
+ */
+bool FileAppender::flushIfDue()
+{
+    if ( pendingBytes >= bufferSize
+         || ( flushInterval > 0
+              && LogTimestamp::now() - pendingSince >= (qint64)flushInterval * 1000000 )
+    ) {
+        return flush();
+    }
+
+    return valid;
+}
+
+/** open log file and set FileAppender#valid flag
+ * if no error occured
+ *
+ * @return true if file and stream opened<br>
+ *         false otherwise
+ */
+bool FileAppender::open()
+{
+    bool status = logfile.open( QIODevice::Append
+                                | QIODevice::Text
+                              );
+
+    if ( status )
+    {
+        if ( lfStream.status() == QTextStream::Ok )
+        {
+            valid = true;
+        }
+        else
+        {
+#if LQTL_ENABLE_LOGGER_LOGGING
+            std::cerr << FUNCTION_NAME
+                    << " unable to create text stream: "
+                    << lfStream.status()
+                    << std::endl;
+#endif
+        }
+    }
+    else
+    {
+#if LQTL_ENABLE_LOGGER_LOGGING
+        std::cerr << FUNCTION_NAME
+                << " unable to open file: "
+                << logfile.error()
+                << std::endl;
+#endif
+    }
+
+    return valid;
+}
+
+/** reopen implementation
+ *
+ * flushes stream, closes log file and opens
+ * file with the same name, so messages go to new file
+ * after log file was renamed (i.e. by logrotate)
+ *
+ * @return true if file reopened<br>
+ *         false otherwise
+ */
+bool FileAppender::reopen()
+{
+#if LQTL_ENABLE_LOGGER_LOGGING
+    std::clog << FUNCTION_NAME << std::endl;
+#endif
+
+    if ( valid )
+    {
+        lfStream.flush();
+        pendingBytes = 0;
+        logfile.close();
+        valid = false;
+    }
+
+    lfStream.setDevice( &logfile );
+
+    return open();
+}
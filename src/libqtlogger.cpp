@@ -27,29 +27,195 @@
 // OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include    <iostream>
+#include    <stdio.h>
 
 #include    <QMapIterator>
 #include    <QStringList>
+#include    <QVector>
+#include    <QHash>
+#include    <QFileInfo>
 
 #include    "libqtlogger_common.h"
 #include    "libqtlogger.h"
+#include    "crashhandler.h"
+#include    "controlserver.h"
 
 using namespace ilardm::lib::qtlogger;
 
+/** name of default module (see QtLogger#defaultModuleLevel)
+ */
+static const char defaultModuleName[] = "-default";
+
+/** module ids registry shared by all logger instances,
+ * so call-site module id is valid for any of them.
+ */
+typedef struct {
+    QMutex                  mutex;  /**< registry guard */
+    QHash< QString, int >   ids;    /**< mapping of module name to its id */
+    QStringList             names;  /**< module names indexed by module id */
+} MODULE_REGISTRY;
+
+/** get module ids registry.
+ *
+ * constructed on first call, so modules may be
+ * registered during static initialization.
+ *
+ * @return module ids registry
+ */
+static MODULE_REGISTRY& moduleRegistry()
+{
+    static MODULE_REGISTRY registry;
+
+    return registry;
+}
+
+/** find id of registered module.
+ *
+ * unlike QtLogger#registerModule does not register
+ * unknown module.
+ *
+ * @param module module name
+ *
+ * @return module id<br>
+ *         -1 if module is not registered
+ */
+static int findModule( const QString& module )
+{
+    MODULE_REGISTRY& registry = moduleRegistry();
+
+    registry.mutex.lock();
+    int id = registry.ids.value( module, -1 );
+    registry.mutex.unlock();
+
+    return id;
+}
+
+/** find name of registered module.
+ *
+ * @param id        module id returned by QtLogger#registerModule
+ * @param module    receives module name
+ *
+ * @return true if module registered<br>
+ *         false otherwise
+ */
+static bool findModuleName( int id, QString& module )
+{
+    MODULE_REGISTRY& registry = moduleRegistry();
+
+    registry.mutex.lock();
+    bool registered = ( id >= 0
+                        && id < registry.names.size() );
+    if ( registered )
+    {
+        module = registry.names.at( id );
+    }
+    registry.mutex.unlock();
+
+    return registered;
+}
+
+/** get names of all registered modules.
+ *
+ * @return module names indexed by module id
+ */
+static QStringList registeredModules()
+{
+    MODULE_REGISTRY& registry = moduleRegistry();
+
+    registry.mutex.lock();
+    QStringList names = registry.names;
+    registry.mutex.unlock();
+
+    return names;
+}
+
+/** record of module without log level
+ * (see QtLogger#moduleLevels)
+ */
+static const QtLogger::MODULE_LEVEL noModuleLevel = { QtLogger::LL_STUB, false, false };
+
+/** source of QtLogger#instanceId
+ */
+static QBasicAtomicInt instanceCounter = Q_BASIC_ATOMIC_INITIALIZER( 0 );
+/** source of QtLogger#levelsGeneration values
+ */
+static QBasicAtomicInt generationCounter = Q_BASIC_ATOMIC_INITIALIZER( 0 );
+
+/** get new module log levels generation.
+ *
+ * generations are unique among all logger instances,
+ * so call-site cache filled by one instance is never
+ * valid for another one (see QtLogger#isModuleLevelEnabled).
+ * 0 is skipped: it is initial value of call-site cache.
+ *
+ * @return generation
+ */
+static int nextLevelsGeneration()
+{
+    int generation = 0;
+    do
+    {
+        generation = generationCounter.fetchAndAddOrdered( 1 ) + 1;
+    } while ( ( (uint)generation << QtLogger::LEVEL_CACHE_BITS ) == 0 );
+
+    return generation;
+}
+
 /** logger object constructor.
  *
- * initializes internal QtLogger#currentLevel,
- * initializes #ll_string array with string represenattion of #LOG_LEVEL,
+ * constructs independent logger instance with its own
+ * queue, thread, writers and module levels. default instance
+ * used by LOG_* macros is returned by QtLogger#getInstance,
+ * other instances are used by LOG_*_TO macros.
+ *
+ * initializes QtLogger#instanceId, internal QtLogger#currentLevel,
+ * QtLogger#thresholdLevel and QtLogger#levelsGeneration,
+ * initializes #ll_string array with string represenattion of #LOG_LEVEL
+ * and its Latin-1 copy #ll_latin1,
  * initializes QtLogger#defaultModuleLevel with "-default",
  * initializes QtLogger#settingsSection with "logging",
  * launches logger thread QtLogger#run
  */
 QtLogger::QtLogger()
-    : defaultModuleLevel( "-default" ),
+    : instanceId( instanceCounter.fetchAndAddOrdered( 1 ) + 1 ),
+      defaultModuleLevel( defaultModuleName ),
       currentLevel( LL_WARNING ),
+      thresholdLevel( LL_WARNING ),
+      levelsGeneration( nextLevelsGeneration() ),
+      deferredFormatting( false ),
+      timestampPrecision( LogTimestamp::TP_MILLISECONDS ),
+      timestampDate( false ),
+      priorityRing( PRIORITY_RING_CAPACITY ),
+      priorityLevel( -1 ),
+      messageSequence( 0 ),
+      consumerWaiting( 0 ),
+      producersWaiting( 0 ),
+      queueEngine( QE_SHARED_RING ),
+      mergeSkew( DEFAULT_MERGE_SKEW ),
+      threadRingsGeneration( 0 ),
+      queueMessagesLimit( 0 ),
+      queueBytesLimit( 0 ),
+      overflowPolicy( OP_BLOCK ),
+      overflowLevel( LL_WARNING ),
+      droppedTotal( 0 ),
+      consumerSpin( DEFAULT_CONSUMER_SPIN ),
+      flushRequested( 0 ),
+      flushCompleted( 0 ),
+      flushLevel( LL_ERROR ),
+      shutdown( false ),
+      pendingWriters( NULL ),
+      moduleLevels( MODULE_TABLE_RESERVE, noModuleLevel ),
       mmMutex(QMutex::Recursive),    // allow loadModuleLevels to lock
       settings( NULL ),
-      settingsSection( "logging" )
+      settingsSection( "logging" ),
+      reloadInterval( 0 ),
+      reloadFormat( QSettings::NativeFormat ),
+      reloadSize( -1 ),
+      reloadCheckTime( 0 ),
+      reopenRequested( 0 ),
+      writtenMessages( 0 ),
+      startTime( LogTimestamp::now() ),
+      controlServer( NULL )
 {
 #if LQTL_ENABLE_LOGGER_LOGGING
     std::clog << FUNCTION_NAME << std::endl;
@@ -66,18 +232,32 @@ QtLogger::QtLogger()
               << "      "       // LL_STUB
               ;
 
+    for ( int i = 0; i < ll_string.size(); i++ )
+    {
+        ll_latin1 << ll_string[ i ].toLatin1();
+    }
+
     this->start();
 }
 
 /** logger object destructor.
  *
- * currently does nothing.
+ * calls QtLogger#finishLogging if it was not called yet.
  */
 QtLogger::~QtLogger()
 {
 #if LQTL_ENABLE_LOGGER_LOGGING
     std::clog << FUNCTION_NAME << std::endl;
 #endif
+
+    mqMutex.lock();
+    bool finished = shutdown;
+    mqMutex.unlock();
+
+    if ( !finished )
+    {
+        finishLogging();
+    }
 }
 
 /** singleton logger object constructor.
@@ -123,6 +303,10 @@ void QtLogger::foo( void* bar )
  * if called from fooNameSpace::FooClass::fooMethod() --
  * module name = "fooNameSpace--FooClass".
  *
+ * relatively expensive, so #LQTL_LOG_WRITE calls it
+ * only once per call site and uses QtLogger#registerModule
+ * result afterwards.
+ *
  * @param funcname  should be #FUNCTION_NAME
  * @param filename  should be __FILE__
  *
@@ -139,35 +323,55 @@ QString QtLogger::determineModule( const char* funcname, const char* filename )
             << std::endl;
 #endif
 
-    // TODO: optimize
-    static const char* defaultModule = (const char*)(QtLogger::getInstance().defaultModuleLevel.toStdString().c_str());
+    static const QString defaultModule( defaultModuleName );
+
+    // scan raw strings and build resulting string only once
+    const char* begin = NULL;
+    const char* end = NULL;
 
-    QString ret( funcname ? funcname : defaultModule );
-    if ( ret.contains("(") )
+    const char* delim = ( funcname ? strchr( funcname, '(' ) : NULL );
+    if ( delim )
     {
         // function
 
-        int delim = ret.indexOf("(");
-        int space = ret.lastIndexOf( " ", delim );
-
-        ret = ret.mid( space, delim - space );
+        begin = funcname;
+        for ( const char* p = delim; p > funcname; p-- )
+        {
+            if ( *(p-1) == ' ' )
+            {
+                begin = p;
+                break;
+            }
+        }
 
-        if ( ret.contains( "::" ) )
+        end = delim;
+        for ( const char* p = delim - 1; p > begin; p-- )
         {
-            // class || namespace
+            if ( *p == ':'
+                 && *(p-1) == ':'
+            ) {
+                // class || namespace
 
-            delim = ret.lastIndexOf( "::" );
-            ret = ret.left( delim );
+                end = p - 1;
+                break;
+            }
         }
     }
-    else
+    else if ( filename )
     {
         // file
 
-        ret = QString( filename ? LQTL_FILENAME_FROM_PATH( filename ) : defaultModule );
+        begin = LQTL_FILENAME_FROM_PATH( filename );
+        end = begin + strlen( begin );
+    }
+    else
+    {
+        return defaultModule;
     }
 
-    ret = ret.replace(":", "-").trimmed();
+    QString ret = QString::fromLatin1( begin, (int)( end - begin ) )
+                    .replace( QChar(':'), QChar('-') )
+                    .trimmed();
 
 #if LQTL_ENABLE_LOGGER_LOGGING
     std::clog << FUNCTION_NAME
@@ -179,6 +383,66 @@ QString QtLogger::determineModule( const char* funcname, const char* filename )
     return ret;
 }
 
+/** assigns id to module name.
+ *
+ * returns the same id for equal module names,
+ * so result may be cached and passed to QtLogger#log
+ * instead of module name. ids are shared by all
+ * logger instances.
+ *
+ * @param module module name
+ *
+ * @return module id
+ */
+int QtLogger::registerModule( const QString& module )
+{
+#if LQTL_ENABLE_LOGGER_LOGGING
+    std::clog << FUNCTION_NAME
+            << " module: "
+            << module.toStdString()
+            << std::endl;
+#endif
+
+    MODULE_REGISTRY& registry = moduleRegistry();
+
+    registry.mutex.lock();
+    int id = registry.ids.value( module, -1 );
+    if ( id < 0 )
+    {
+        id = registry.names.size();
+        registry.names.append( module );
+        registry.ids.insert( module, id );
+    }
+    registry.mutex.unlock();
+
+#if LQTL_ENABLE_LOGGER_LOGGING
+    std::clog << FUNCTION_NAME
+            << " id: "
+            << id
+            << std::endl;
+#endif
+
+    return id;
+}
+
+/** retrieve module name by module id.
+ *
+ * @param id module id returned by QtLogger#registerModule
+ *
+ * @return module name<br>
+ *         or QtLogger#defaultModuleLevel if no such id registered
+ */
+QString QtLogger::moduleName( int id )
+{
+    QString ret;
+    if ( !findModuleName( id, ret ) )
+    {
+        ret = defaultModuleName;
+    }
+
+    return ret;
+}
+
 /** converts #LOG_LEVEL value to string representation.
  *
  * uses initialized in QtLogger#QtLogger #ll_string array.
@@ -206,20 +470,43 @@ QString QtLogger::describeLogLevel(QtLogger::LOG_LEVEL level)
 /** logger thread.
  *
  * runs in infinite loop until QtLogger#shutdown flag is set,
- * waites on QtLogger#mqWait condition until message added into
- * QtLogger#messageQueue,
- * passes all messages in queue to registered log writes from
- * QtLogger#writersList
- * and waits again.
+ * takes records from QtLogger#messageRing and per-thread rings
+ * merged by timestamp (see LogRecordMerger),
+ * forms messages from them (see QtLogger#formatRecord),
+ * passes messages in batches of up to #DRAIN_BATCH_SIZE
+ * to registered log writes (see QtLogger#writeBatch)
+ * followed by summary of messages dropped since previous batch
+ * (see QtLogger#appendDropSummary)
+ * and goes to sleep on QtLogger#mqWait condition when
+ * all rings are empty (or until the oldest record held
+ * by merge skew window may be passed).
+ *
+ * before going to sleep polls rings for a while (see
+ * QtLogger#setConsumerSpin), so records arriving shortly
+ * do not cost futex syscalls on both sides.
+ *
+ * before going to sleep sets QtLogger#consumerWaiting flag
+ * and checks rings once more under QtLogger#mqMutex, so record
+ * enqueued concurrently either is seen by the check or its
+ * producer sees the flag and wakes thread up (see QtLogger#enqueue).
+ *
+ * records are popped under QtLogger#popMutex, so producers
+ * may discard the oldest records on overflow.
+ *
+ * priority lane (see QtLogger#drainPriorityLane) is drained
+ * before each batch of other records.
  *
- * since messages may be enqueued while log writers doing some stuff,
- * this method executes log writers until queue is empty and only then
- * goes to sleep on condition.
+ * on flush request (see QtLogger#flush) remembers reservation
+ * positions of all rings (see LogRecordMerger#setBarrier), drains
+ * rings ignoring skew window and once all records reserved before
+ * those positions are written flushes writers and reports flush
+ * completion. records enqueued after request do not delay it,
+ * logger thread parks between checks as usual.
  *
- * twice locking message queue: right after wake up and before going to sleep
- * to ensure if queue is empty.
+ * polls settings file if enabled (see QtLogger#setConfigReloadInterval),
+ * reopens writers on request (see QtLogger#reopenWriters).
  *
- * writers list is locked until all writers with current message is executed.
+ * on shutdown drains rings ignoring skew window before exit.
  */
 void QtLogger::run()
 {
@@ -229,81 +516,167 @@ void QtLogger::run()
             << std::endl;
 #endif
 
-    QString message;
-
-    while ( !shutdown )
+    LogRecordMerger merger;
+    merger.addSource( &messageRing, false );
+    int ringsGeneration = 0;
+
+    QVector< LogRecord > records( DRAIN_BATCH_SIZE );
+    QStringList batch;
+    int droppedReported[ LL_STUB + 2 ] = { 0 };
+    qint64 holdUntil = 0;
+    int reopenServed = 0;
+    int barrierFlush = 0;
+    bool barrierSet = false;
+    uint priorityBarrier = 0;
+    bool unsynced = false;
+    int spinTime = consumerSpin;
+    bool draining = false;
+    bool done = false;
+
+    while ( !done )
     {
-#if LQTL_ENABLE_LOGGER_LOGGING
-        std::clog << FUNCTION_NAME
-                << " waiting"
-                << std::endl;
-#endif
-        mqMutex.lock();
-        mqWait.wait( &mqMutex );
-#if LQTL_ENABLE_LOGGER_LOGGING
-        std::clog << FUNCTION_NAME
-                << " woken"
-                << std::endl;
-#endif
-        if ( !messageQueue.isEmpty() )
+        adoptWriters();
+        checkConfigReload();
+        adoptThreadRings( merger, ringsGeneration );
+
+        int reopenTarget = reopenRequested;
+        if ( reopenTarget != reopenServed )
         {
-            message = messageQueue.dequeue();
+            QListIterator<LogWriterInterface*> iter( activeWriters );
+            while ( iter.hasNext() )
+            {
+                iter.next()->reopen();
+            }
+            reopenServed = reopenTarget;
         }
-#if LQTL_ENABLE_LOGGER_LOGGING
-        else
-        {
-            std::clog << FUNCTION_NAME
-                    << " queue already empty"
-                    << std::endl;
+
+        int flushTarget = flushRequested;
+        if ( !barrierSet
+             && flushTarget != (int)flushCompleted
+        ) {
+            // rings registered before flush request must be covered
+            adoptThreadRings( merger, ringsGeneration );
+            merger.setBarrier();
+            priorityBarrier = priorityRing.reservedPosition();
+            barrierFlush = flushTarget;
+            barrierSet = true;
         }
-#endif
-        mqMutex.unlock();
 
-        while ( !message.isEmpty() )
+        qint64 skew = ( ( draining || barrierSet ) ? 0 : (qint64)(int)mergeSkew * 1000 );
+        int count = 0;
+        do
         {
-#if LQTL_ENABLE_LOGGER_LOGGING
-            std::clog << FUNCTION_NAME
-                    << " pass message \""
-                    << message.toStdString()
-                    << "\" to writers"
-                    << std::endl;
-#endif
+            drainPriorityLane( records, batch );
 
-            wlMutex.lock();
-            if ( !writersList.isEmpty() )
+            popMutex.lock();
+            for ( count = 0; count < DRAIN_BATCH_SIZE; count++ )
             {
-                QListIterator<LogWriterInterface*> iter( writersList );
-                while ( iter.hasNext() )
+                if ( !merger.next( records[ count ], LogTimestamp::now(), skew, &holdUntil ) )
                 {
-                    LogWriterInterface* writer = iter.next();
-#if LQTL_ENABLE_LOGGER_LOGGING
-                    bool status =
-#endif
-                    writer->writeLog( message );
-
-#if LQTL_ENABLE_LOGGER_LOGGING
-                    std::clog << FUNCTION_NAME
-                            << QString().sprintf( " writer @ %p returned %c",
-                                                  writer,
-                                                  (status?'t':'F')
-                                                ).toStdString()
-                            << std::endl;
-#endif
+                    break;
                 }
             }
-            wlMutex.unlock();
+            popMutex.unlock();
+            wakeProducers();
+
+            int syncLevel = flushLevel;
+            bool urgent = false;
+            for ( int i = 0; i < count; i++ )
+            {
+                urgent = urgent || ( records[ i ].level <= syncLevel );
+                batch.append( formatRecord( records[ i ] ) );
+            }
+            appendDropSummary( batch, droppedReported );
+
+            if ( !batch.isEmpty() )
+            {
+                writeBatch( batch );
+                unsynced = true;
+            }
+            if ( urgent )
+            {
+                syncWriters();
+                unsynced = false;
+            }
+        } while ( count == DRAIN_BATCH_SIZE );
+
+        if ( barrierSet
+             && merger.passedBarrier()
+             && (int)( priorityRing.consumedPosition() - priorityBarrier ) >= 0
+        ) {
+            // every record reserved before flush request is written,
+            // records reserved later do not delay flush
+            flushWriters();
+            completeFlush( barrierFlush );
+            barrierSet = false;
+            unsynced = false;
+            continue;
+        }
+
+        if ( !draining
+             && holdUntil == 0
+        ) {
+            // spin budget grows while records arrive during spin
+            // and shrinks while logger thread parks anyway
+            int maxSpin = consumerSpin;
+            if ( spinForRecords( merger, ringsGeneration, !barrierSet, qMin( spinTime, maxSpin ) ) )
+            {
+                spinTime = maxSpin;
+                continue;
+            }
+            spinTime = qMax( spinTime / 2, maxSpin / 16 );
+        }
 
-            mqMutex.lock();
-            if ( !messageQueue.isEmpty() )
+        if ( unsynced )
+        {
+            // out of messages: let buffering writers write out
+            syncWriters();
+            unsynced = false;
+        }
+
+        mqMutex.lock();
+        consumerWaiting.fetchAndStoreOrdered( 1 );
+        if ( !shutdown
+             && (int)threadRingsGeneration == ringsGeneration
+             && ( barrierSet
+                  || (int)flushRequested == (int)flushCompleted )
+             && !priorityRing.isReady()
+             && !(WRITERS_SNAPSHOT*)pendingWriters
+             && (int)reopenRequested == reopenServed
+        ) {
+            int interval = reloadInterval;
+            if ( holdUntil > 0 )
             {
-                message = messageQueue.dequeue();
+                qint64 delay = ( holdUntil - LogTimestamp::now() ) / 1000000 + 1;
+                mqWait.wait( &mqMutex, (unsigned long)qMax( delay, (qint64)1 ) );
             }
-            else
+            else if ( !merger.isReady() )
             {
-                message.clear();
+                // rings are empty or their oldest records are reserved
+                // but not published: producer wakes us once it publishes
+#if LQTL_ENABLE_LOGGER_LOGGING
+                std::clog << FUNCTION_NAME
+                        << " waiting"
+                        << std::endl;
+#endif
+                if ( interval > 0 )
+                {
+                    // wake up to poll settings file
+                    mqWait.wait( &mqMutex, (unsigned long)interval );
+                }
+                else
+                {
+                    mqWait.wait( &mqMutex );
+                }
             }
-            mqMutex.unlock();
         }
+        consumerWaiting.fetchAndStoreOrdered( 0 );
+        draining = shutdown;
+        done = ( shutdown
+                 && (int)threadRingsGeneration == ringsGeneration
+                 && merger.isIdle()
+                 && priorityRing.isEmpty() );
+        mqMutex.unlock();
     }
 
 #if LQTL_ENABLE_LOGGER_LOGGING
@@ -315,96 +688,389 @@ void QtLogger::run()
     this->quit();
 }
 
-/** converts passed data to hex representation.
+/** poll rings for a while before parking logger thread.
  *
- * uses formatting like hexdump(1) utility
+ * yields processor between checks.
  *
- * @param data      data buffer to convert
- * @param datasz    number of bytes to convert
+ * @param merger        logger thread merger
+ * @param generation    QtLogger#threadRingsGeneration seen by logger thread
+ * @param watchFlush    return on new flush request
+ * @param spin          polling time, microseconds
  *
- * @return string representation of passed data<br>
- *         or blank string if datasize equals 0
- *         or data pointer equals NULL
+ * @return true if records, new rings or flush request arrived<br>
+ *         false if rings still empty after polling time
  */
-QString QtLogger::hexData( const void* data, const size_t datasz )
+bool QtLogger::spinForRecords( LogRecordMerger& merger, int generation, bool watchFlush, int spin )
 {
-#if LQTL_ENABLE_LOGGER_LOGGING
-    std::clog << FUNCTION_NAME
-            << " data @"
-            << QString().sprintf( " %p", data ).toStdString()
-            << " size: "
-            << datasz
-            << std::endl;
-#endif
-
-    QString result("\n");
-    QString hexline("");
-    QString asciidata("");
-    quint8* p = (quint8*)data;
-
-    // typical line
-    // 0x0010: 0000 0000 0000 0000 0000 0000 032a 0010 '.............*..'
-    // length of hexes should be 47
-
-    for ( size_t i = 0; i < datasz; i++ )
+    if ( spin <= 0 )
     {
-        if ( i % 16 == 0 )
-        {
-            hexline.append( QString().sprintf( "0x%04X: ", (uint)i ) );
-        }
+        return false;
+    }
 
-        if ( i % 2 == 0 )
-        {
-            hexline.append( QString().sprintf( "%02x", p[i] ) );
-        }
-        else
-        {
-            hexline.append( QString().sprintf( "%02x ", p[i] ) );
+    qint64 deadline = LogTimestamp::now() + (qint64)spin * 1000;
+    do
+    {
+        if ( merger.isReady()
+             || priorityRing.isReady()
+             || (int)threadRingsGeneration != generation
+             || ( watchFlush
+                  && (int)flushRequested != (int)flushCompleted )
+        ) {
+            return true;
         }
-        // append with char (if printable) or with '.' symbol
-        asciidata.append( (const char)( (p[i] >= 0x20 && p[i] <= 0x7e) ? p[i] : 0x2e ) );
+        QThread::yieldCurrentThread();
+    } while ( LogTimestamp::now() < deadline );
 
-        if ( (i+1) % 16 == 0)
-        {
-            result.append( QString().sprintf( "%-50s'%s'\n",
-                                              hexline.toStdString().c_str(),
-                                              asciidata.toStdString().c_str()
-                                              )
-                           );
+    return false;
+}
 
-            asciidata.clear();
-            hexline.clear();
-        }
-    }
+/** flush all log writers.
+ *
+ * see LogWriterInterface#flush
+ */
+void QtLogger::flushWriters()
+{
+#if LQTL_ENABLE_LOGGER_LOGGING
+    std::clog << FUNCTION_NAME << std::endl;
+#endif
 
-    if ( !asciidata.isEmpty() )
+    QListIterator<LogWriterInterface*> iter( activeWriters );
+    while ( iter.hasNext() )
     {
-        result.append( QString().sprintf( "%-50s'%s'\n",
-                                          hexline.toStdString().c_str(),
-                                          asciidata.toStdString().c_str()
-                                          )
-                       );
+        iter.next()->flush();
     }
-
-    return result;
 }
 
-/** registers one more log writer object.
- *
- * checks passed pointer,
- * locks QtLogger#wlMutex,
- * appends pointer to QtLogger#writersList
- * and unlocks mutex
+/** let buffering log writers write out buffered messages.
  *
- * @param writer
+ * called when logger thread runs out of messages and
+ * after messages of QtLogger#flushLevel are written.
  *
- * @return true if successfully added<br>
- *         false otherwise (i.e. pointer is NULL)
+ * see LogWriterInterface#sync
  */
-bool QtLogger::addWriter( LogWriterInterface* writer )
+void QtLogger::syncWriters()
 {
 #if LQTL_ENABLE_LOGGER_LOGGING
-    std::clog << FUNCTION_NAME
+    std::clog << FUNCTION_NAME << std::endl;
+#endif
+
+    QListIterator<LogWriterInterface*> iter( activeWriters );
+    while ( iter.hasNext() )
+    {
+        iter.next()->sync();
+    }
+}
+
+/** publish copy of QtLogger#writersList for logger thread.
+ *
+ * must be called with QtLogger#wlMutex locked.
+ *
+ * takes previous snapshot if logger thread has not adopted
+ * it yet, so writers retired by it are not lost, then puts
+ * new one into QtLogger#pendingWriters and wakes up logger
+ * thread.
+ *
+ * @param retired removed writer to delete, NULL if none
+ */
+void QtLogger::publishWriters( LogWriterInterface* retired )
+{
+    WRITERS_SNAPSHOT* snapshot = new WRITERS_SNAPSHOT();
+    snapshot->writers = writersList;
+
+    WRITERS_SNAPSHOT* previous = pendingWriters.fetchAndStoreOrdered( NULL );
+    if ( previous )
+    {
+        snapshot->retired = previous->retired;
+        delete previous;
+    }
+    if ( retired )
+    {
+        snapshot->retired.append( retired );
+    }
+
+    pendingWriters.fetchAndStoreOrdered( snapshot );
+
+    wakeConsumer();
+}
+
+/** switch logger thread to the latest published writers list.
+ *
+ * called from logger thread (or after it exits) only.
+ * flushes and deletes retired writers: logger thread
+ * no longer uses them.
+ */
+void QtLogger::adoptWriters()
+{
+    WRITERS_SNAPSHOT* snapshot = pendingWriters.fetchAndStoreOrdered( NULL );
+    if ( !snapshot )
+    {
+        return;
+    }
+
+    activeWriters = snapshot->writers;
+
+    while ( !snapshot->retired.isEmpty() )
+    {
+        LogWriterInterface* writer = snapshot->retired.takeFirst();
+        writer->flush();
+        delete writer;
+    }
+    delete snapshot;
+
+#if LQTL_ENABLE_LOGGER_LOGGING
+    std::clog << FUNCTION_NAME
+            << " writers: "
+            << activeWriters.size()
+            << std::endl;
+#endif
+}
+
+/** report flush completion.
+ *
+ * @param sequence the latest flush request served
+ */
+void QtLogger::completeFlush( int sequence )
+{
+    flushMutex.lock();
+    flushCompleted.fetchAndStoreOrdered( sequence );
+    flushWait.wakeAll();
+    flushMutex.unlock();
+}
+
+/** pass batch of messages to log writers.
+ *
+ * passes batch to each writer from QtLogger#activeWriters
+ * (see LogWriterInterface#writeLogBatch) without locking
+ * and clears the batch.
+ *
+ * @param batch formed log messages
+ */
+void QtLogger::writeBatch( QStringList& batch )
+{
+#if LQTL_ENABLE_LOGGER_LOGGING
+    std::clog << FUNCTION_NAME
+            << " pass "
+            << batch.size()
+            << " messages to writers"
+            << std::endl;
+#endif
+
+    QListIterator<LogWriterInterface*> iter( activeWriters );
+    while ( iter.hasNext() )
+    {
+        LogWriterInterface* writer = iter.next();
+#if LQTL_ENABLE_LOGGER_LOGGING
+        bool status =
+#endif
+        writer->writeLogBatch( batch );
+
+#if LQTL_ENABLE_LOGGER_LOGGING
+        std::clog << FUNCTION_NAME
+                << QString().sprintf( " writer @ %p returned %c",
+                                      writer,
+                                      (status?'t':'F')
+                                    ).toStdString()
+                << std::endl;
+#endif
+    }
+
+    writtenMessages.fetchAndAddRelaxed( batch.size() );
+    batch.clear();
+}
+
+/** append summary of dropped messages to batch.
+ *
+ * compares counters of dropped messages with values reported
+ * by previous call and appends message like<br>
+ * "12 messages dropped (WARN: 2 debug: 10)"<br>
+ * if some messages were dropped since then.
+ *
+ * total is sum of per level differences actually read,
+ * so it always matches per level numbers. QtLogger#droppedTotal
+ * is only checked first to skip reading per level counters.
+ *
+ * @param batch     formed log messages
+ * @param reported  per level counters reported by previous call,
+ *                  #LL_STUB + 2 items, the last one is total
+ */
+void QtLogger::appendDropSummary( QStringList& batch, int* reported )
+{
+    if ( (int)droppedTotal == reported[ LL_STUB + 1 ] )
+    {
+        return;
+    }
+
+    int total = 0;
+    QString levels;
+    for ( int i = 0; i <= LL_STUB; i++ )
+    {
+        int dropped = droppedMessages[ i ];
+        if ( dropped != reported[ i ] )
+        {
+            levels.append( QString( " %1: %2" )
+                            .arg( ll_string[ i ].trimmed() )
+                            .arg( dropped - reported[ i ] ) );
+            total += dropped - reported[ i ];
+            reported[ i ] = dropped;
+        }
+    }
+    // per level counters are incremented before total
+    // (see QtLogger#countDropped), so they may be ahead of it
+    reported[ LL_STUB + 1 ] += total;
+
+    if ( total == 0 )
+    {
+        return;
+    }
+
+    batch.append( formatNotice( LL_WARNING,
+                                QString( " %1 messages dropped (%2)" )
+                                    .arg( total )
+                                    .arg( levels.trimmed() ) ) );
+}
+
+/** write messages of priority lane.
+ *
+ * pops all records from QtLogger#priorityRing, passes them
+ * to log writers and syncs writers (see QtLogger#syncWriters),
+ * so important messages do not wait behind less important ones.
+ * sync does not wait for asynchronous writers, so slow writer
+ * (see #AsyncAppender) does not delay logger thread.
+ *
+ * @param records   logger thread records buffer
+ * @param batch     logger thread messages batch, empty
+ *
+ * @return true if messages written<br>
+ *         false if priority lane is empty
+ */
+bool QtLogger::drainPriorityLane( QVector< LogRecord >& records, QStringList& batch )
+{
+    if ( priorityRing.isEmpty() )
+    {
+        return false;
+    }
+
+    int count = 0;
+    do
+    {
+        popMutex.lock();
+        for ( count = 0; count < records.size(); count++ )
+        {
+            if ( !priorityRing.pop( records[ count ] ) )
+            {
+                break;
+            }
+        }
+        popMutex.unlock();
+        wakeProducers();
+
+        for ( int i = 0; i < count; i++ )
+        {
+            batch.append( formatRecord( records[ i ] ) );
+        }
+
+        if ( !batch.isEmpty() )
+        {
+            writeBatch( batch );
+        }
+    } while ( count == records.size() );
+
+    syncWriters();
+
+    return true;
+}
+
+/** converts passed data to hex representation.
+ *
+ * uses formatting like hexdump(1) utility
+ *
+ * @param data      data buffer to convert
+ * @param datasz    number of bytes to convert
+ *
+ * @return string representation of passed data<br>
+ *         or blank string if datasize equals 0
+ *         or data pointer equals NULL
+ */
+QString QtLogger::hexData( const void* data, const size_t datasz )
+{
+#if LQTL_ENABLE_LOGGER_LOGGING
+    std::clog << FUNCTION_NAME
+            << " data @"
+            << QString().sprintf( " %p", data ).toStdString()
+            << " size: "
+            << datasz
+            << std::endl;
+#endif
+
+    QString result("\n");
+    QString hexline("");
+    QString asciidata("");
+    quint8* p = (quint8*)data;
+
+    // typical line
+    // 0x0010: 0000 0000 0000 0000 0000 0000 032a 0010 '.............*..'
+    // length of hexes should be 47
+
+    for ( size_t i = 0; i < datasz; i++ )
+    {
+        if ( i % 16 == 0 )
+        {
+            hexline.append( QString().sprintf( "0x%04X: ", (uint)i ) );
+        }
+
+        if ( i % 2 == 0 )
+        {
+            hexline.append( QString().sprintf( "%02x", p[i] ) );
+        }
+        else
+        {
+            hexline.append( QString().sprintf( "%02x ", p[i] ) );
+        }
+        // append with char (if printable) or with '.' symbol
+        asciidata.append( (const char)( (p[i] >= 0x20 && p[i] <= 0x7e) ? p[i] : 0x2e ) );
+
+        if ( (i+1) % 16 == 0)
+        {
+            result.append( QString().sprintf( "%-50s'%s'\n",
+                                              hexline.toStdString().c_str(),
+                                              asciidata.toStdString().c_str()
+                                              )
+                           );
+
+            asciidata.clear();
+            hexline.clear();
+        }
+    }
+
+    if ( !asciidata.isEmpty() )
+    {
+        result.append( QString().sprintf( "%-50s'%s'\n",
+                                          hexline.toStdString().c_str(),
+                                          asciidata.toStdString().c_str()
+                                          )
+                       );
+    }
+
+    return result;
+}
+
+/** registers one more log writer object.
+ *
+ * checks passed pointer,
+ * locks QtLogger#wlMutex,
+ * appends pointer to QtLogger#writersList,
+ * publishes new list for logger thread (see QtLogger#publishWriters)
+ * and unlocks mutex
+ *
+ * @param writer
+ *
+ * @return true if successfully added<br>
+ *         false otherwise (i.e. pointer is NULL)
+ */
+bool QtLogger::addWriter( LogWriterInterface* writer )
+{
+#if LQTL_ENABLE_LOGGER_LOGGING
+    std::clog << FUNCTION_NAME
             << " writer: "
             << (writer?(QString().sprintf( "%p", writer ).toStdString()):"(null)")
             << std::endl;
@@ -422,6 +1088,7 @@ bool QtLogger::addWriter( LogWriterInterface* writer )
 
    wlMutex.lock();
    writersList.append( writer );
+   publishWriters( NULL );
 
 #if LQTL_ENABLE_LOGGER_LOGGING
     std::clog << FUNCTION_NAME
@@ -434,12 +1101,88 @@ bool QtLogger::addWriter( LogWriterInterface* writer )
     return true;
 }
 
+/** unregisters log writer object.
+ *
+ * messages already passed to logger thread may still
+ * be written by removed writer, after that logger thread
+ * flushes and deletes it.
+ *
+ * @param writer registered writer
+ *
+ * @return true if successfully removed<br>
+ *         false if writer is not registered
+ */
+bool QtLogger::removeWriter( LogWriterInterface* writer )
+{
+#if LQTL_ENABLE_LOGGER_LOGGING
+    std::clog << FUNCTION_NAME
+            << " writer: "
+            << (writer?(QString().sprintf( "%p", writer ).toStdString()):"(null)")
+            << std::endl;
+#endif
+
+    wlMutex.lock();
+    bool removed = writersList.removeOne( writer );
+    if ( removed )
+    {
+        publishWriters( writer );
+    }
+    wlMutex.unlock();
+
+    return removed;
+}
+
+/** replaces registered log writer object.
+ *
+ * logger thread switches to replacement between two
+ * batches of messages, so no message is lost or delayed
+ * (i.e. to switch log file). replaced writer is flushed
+ * and deleted by logger thread.
+ *
+ * @param writer        registered writer
+ * @param replacement   new writer
+ *
+ * @return true if successfully replaced<br>
+ *         false if writer is not registered or replacement is NULL
+ */
+bool QtLogger::replaceWriter( LogWriterInterface* writer, LogWriterInterface* replacement )
+{
+#if LQTL_ENABLE_LOGGER_LOGGING
+    std::clog << FUNCTION_NAME
+            << " writer: "
+            << (writer?(QString().sprintf( "%p", writer ).toStdString()):"(null)")
+            << " replacement: "
+            << (replacement?(QString().sprintf( "%p", replacement ).toStdString()):"(null)")
+            << std::endl;
+#endif
+
+    if ( !replacement )
+    {
+        return false;
+    }
+
+    wlMutex.lock();
+    int index = writersList.indexOf( writer );
+    if ( index >= 0 )
+    {
+        writersList.replace( index, replacement );
+        publishWriters( writer );
+    }
+    wlMutex.unlock();
+
+    return ( index >= 0 );
+}
+
 /** set log level for module.
  *
  * assigns log level for given module.
  * if log level already set - reassigns it if
  * not marked as final or final param is set to true
  *
+ * level applies to child modules without own level as well,
+ * i.e. level of "foonm" applies to "foonm--Foo"
+ * (see QtLogger#resolveModuleLevel).
+ *
  * @param module    module name
  * @param lvl       log level for module
  * @param final     determines whether override is forced
@@ -471,363 +1214,1745 @@ QtLogger::LOG_LEVEL QtLogger::setModuleLevel( QString module, LOG_LEVEL lvl, boo
 #endif
     }
 
-    bool insert = false;
+    int id = registerModule( module );
 
-    // check if exists
-    const MODULE_LEVEL* mlvl = getModuleLevel( module );
-    if ( !mlvl )
-    {
-        insert = true;
-    }
-    else
-    {
-        // reset if !final
-        if ( mlvl->final
-             && !final
-        ) {
+    mmMutex.lock();
+    MODULE_LEVEL& mlvl = moduleSlot( id );
+    if ( mlvl.final
+         && !final
+    ) {
 #if LQTL_ENABLE_LOGGER_LOGGING
-            std::clog << FUNCTION_NAME
-                    << " log level for this module already final. rejected"
-                    << std::endl;
+        std::clog << FUNCTION_NAME
+                << " log level for this module already final. rejected"
+                << std::endl;
 #endif
-            return mlvl->level;
-        }
-        else
-        {
-#if LQTL_ENABLE_LOGGER_LOGGING
-            std::clog << FUNCTION_NAME
-                    << " replace existsing log level"
-                    << std::endl;
+        LOG_LEVEL level = mlvl.level;
+        mmMutex.unlock();
+
+        return level;
+    }
+
+#if LQTL_ENABLE_LOGGER_LOGGING
+    std::clog << FUNCTION_NAME
+            << ( mlvl.level == LL_STUB ? " insert new" : " replace existsing" )
+            << " loglevel for module"
+            << std::endl;
 #endif
-            delete( mlvl );
-            insert = true;
-        }
+    mlvl.level = lvl;
+    mlvl.final = final;
+    mlvl.inherited = false;
+    mmMutex.unlock();
+
+    updateThresholdLevel();
+
+    return lvl;
+}
+
+/** drop log level set for module.
+ *
+ * module inherits level from parent module again
+ * (see QtLogger#resolveModuleLevel), even if
+ * its level was marked final.
+ *
+ * @param module module name
+ *
+ * @return true if module level reset<br>
+ *         false if module is unknown
+ */
+bool QtLogger::resetModuleLevel( QString module )
+{
+#if LQTL_ENABLE_LOGGER_LOGGING
+    std::clog << FUNCTION_NAME
+            << " module: "
+            << module.toStdString()
+            << std::endl;
+#endif
+
+    int id = findModule( module );
+    bool known = false;
+
+    mmMutex.lock();
+    if ( id >= 0
+         && id < moduleLevels.size()
+         && moduleLevels.at( id ).level != LL_STUB
+    ) {
+        MODULE_LEVEL& mlvl = moduleLevels[ id ];
+        mlvl.inherited = true;
+        mlvl.final = false;
+        known = true;
+        updateThresholdLevel();
+    }
+    mmMutex.unlock();
+
+    return known;
+}
+
+/** retrieve log level for given module.
+ *
+ * @param module module name
+ *
+ * @return copy of module log level structure<br>
+ *         structure with LL_STUB level if no module found.
+ */
+QtLogger::MODULE_LEVEL QtLogger::getModuleLevel( QString module )
+{
+#if LQTL_ENABLE_LOGGER_LOGGING
+    std::clog << FUNCTION_NAME
+            << " module: "
+            << module.toStdString()
+            << std::endl;
+#endif
+
+    int id = findModule( module );
+    MODULE_LEVEL ret = noModuleLevel;
+
+    mmMutex.lock();
+    if ( id >= 0
+         && id < moduleLevels.size()
+    ) {
+        ret = moduleLevels.at( id );
     }
+    mmMutex.unlock();
+
+    return ret;
+}
 
-    if ( insert )
+/** get log level record of module for update.
+ *
+ * grows QtLogger#moduleLevels if id is beyond it,
+ * so returned reference is valid only until
+ * QtLogger#mmMutex is unlocked.
+ *
+ * must be called with QtLogger#mmMutex locked.
+ *
+ * @param id module id returned by QtLogger#registerModule
+ *
+ * @return module log level record
+ */
+QtLogger::MODULE_LEVEL& QtLogger::moduleSlot( int id )
+{
+    if ( id >= moduleLevels.size() )
     {
+        int size = moduleLevels.size();
+
 #if LQTL_ENABLE_LOGGER_LOGGING
         std::clog << FUNCTION_NAME
-                << " insert new loglevel for module"
+                << " grow module table: "
+                << size
                 << std::endl;
 #endif
-        MODULE_LEVEL* nmlvl = new MODULE_LEVEL();
-        nmlvl->level = lvl;
-        nmlvl->final = final;
 
-        if ( !nmlvl )
+        moduleLevels.resize( qMax( id + 1, size * 2 ) );
+        for ( int i = size; i < moduleLevels.size(); i++ )
+        {
+            moduleLevels[ i ] = noModuleLevel;
+        }
+    }
+
+    return moduleLevels[ id ];
+}
+
+/** recalculate QtLogger#thresholdLevel.
+ *
+ * resolves again levels of modules inherited from parent
+ * modules (see QtLogger#resolveModuleLevel),
+ * takes the most verbose level among QtLogger#currentLevel
+ * and levels of all modules in QtLogger#moduleLevels,
+ * renews QtLogger#levelsGeneration to invalidate
+ * call-site module level caches.
+ * should be called each time any of them changed.
+ */
+void QtLogger::updateThresholdLevel()
+{
+    int threshold = currentLevel;
+
+    mmMutex.lock();
+    QStringList names = registeredModules();
+    for ( int id = 0; id < moduleLevels.size() && id < names.size(); id++ )
+    {
+        MODULE_LEVEL& mlvl = moduleLevels[ id ];
+        if ( mlvl.level == LL_STUB )
+        {
+            continue;
+        }
+
+        if ( mlvl.inherited )
+        {
+            mlvl.level = resolveModuleLevel( names.at( id ) );
+        }
+
+        if ( mlvl.level > threshold )
         {
+            threshold = mlvl.level;
+        }
+    }
+    mmMutex.unlock();
+
+    thresholdLevel = threshold;
+    levelsGeneration.fetchAndStoreOrdered( nextLevelsGeneration() );
+
 #if LQTL_ENABLE_LOGGER_LOGGING
-            std::cerr << FUNCTION_NAME
-                    << " unable to create loglevel for module"
-                    << std::endl;
+    std::clog << FUNCTION_NAME
+            << " threshold level: "
+            << threshold
+            << std::endl;
 #endif
-            return LL_STUB;
+}
+
+/** find log level of module among levels set for its parents.
+ *
+ * module name is split into segments by '-', empty segments are
+ * skipped (i.e. "foonm--Foo" built by QtLogger#determineModule
+ * from "foonm::Foo" is child of "foonm", not of "foonm-"), the
+ * longest parent having level set (not inherited) wins.
+ *
+ * must be called with QtLogger#mmMutex locked.
+ *
+ * @param module module name
+ *
+ * @return level of the closest parent module<br>
+ *         or QtLogger#currentLevel if no parent has level set
+ */
+QtLogger::LOG_LEVEL QtLogger::resolveModuleLevel( const QString& module )
+{
+    int position = module.lastIndexOf( QChar( '-' ) );
+    while ( position > 0 )
+    {
+        if ( module.at( position - 1 ) == QChar( '-' ) )
+        {
+            // empty segment
+            position--;
+            continue;
+        }
+
+        int id = findModule( module.left( position ) );
+        if ( id >= 0
+             && id < moduleLevels.size()
+             && moduleLevels.at( id ).level != LL_STUB
+             && !moduleLevels.at( id ).inherited
+        ) {
+            return moduleLevels.at( id ).level;
         }
 
+        position = module.lastIndexOf( QChar( '-' ), position - 1 );
+    }
+
+    return currentLevel;
+}
+
+/** get module log level, create inherited
+ * record for module without one.
+ *
+ * level is resolved by QtLogger#resolveModuleLevel once and
+ * resolved again only when any level changes
+ * (see QtLogger#updateThresholdLevel), so hierarchy
+ * costs nothing per message.
+ *
+ * does not change any effective level, so call-site
+ * caches are not invalidated. record is written into
+ * preallocated QtLogger#moduleLevels, so nothing is
+ * allocated unless table is full.
+ *
+ * @param id        module id returned by QtLogger#registerModule
+ * @param module    module name
+ *
+ * @return module log level
+ */
+QtLogger::LOG_LEVEL QtLogger::inheritModuleLevel( int id, const QString& module )
+{
+    mmMutex.lock();
+    MODULE_LEVEL& mlvl = moduleSlot( id );
+    if ( mlvl.level == LL_STUB )
+    {
+        mlvl.level = resolveModuleLevel( module );
+        mlvl.final = false;
+        mlvl.inherited = true;
+    }
+    LOG_LEVEL level = mlvl.level;
+    mmMutex.unlock();
+
+    return level;
+}
+
+/** resolve module log level and store it in call-site cache.
+ *
+ * slow path of QtLogger#isModuleLevelEnabled.
+ * if no loglevel for module record found - creates
+ * inherited one (the same way QtLogger#log does).
+ *
+ * generation is read before module level, so concurrent
+ * level change leaves cache outdated and forces one more refresh.
+ *
+ * @param module    module id returned by QtLogger#registerModule
+ * @param cache     call-site cache to update
+ *
+ * @return new cache value
+ */
+int QtLogger::refreshModuleLevel( int module, QBasicAtomicInt& cache )
+{
+    int generation = levelsGeneration;
+    int level = LL_STUB;
+
+    QString name;
+
+    mmMutex.lock();
+    if ( module >= 0
+         && module < moduleLevels.size()
+         && moduleLevels.at( module ).level != LL_STUB
+    ) {
+        level = moduleLevels.at( module ).level;
+    }
+    else if ( findModuleName( module, name ) )
+    {
+        level = inheritModuleLevel( module, name );
+    }
+    else
+    {
+        level = currentLevel;
+    }
+    mmMutex.unlock();
+
+#if LQTL_ENABLE_LOGGER_LOGGING
+    std::clog << FUNCTION_NAME
+            << " module: "
+            << module
+            << " level: "
+            << level
+            << " generation: "
+            << generation
+            << std::endl;
+#endif
+
+    int packed = (int)( ( (uint)generation << LEVEL_CACHE_BITS ) | (uint)level );
+    cache.fetchAndStoreOrdered( packed );
+
+    return packed;
+}
+
+/** set main-application settings object.
+ *
+ * should be set before QtLogger#saveModuleLevels
+ * or Qtlogger#loadModuleLevels invoked
+ *
+ * @param settings main-application settings object
+ *
+ * @return true if settings object not NULL<br>
+ *         false otherwise
+ */
+bool QtLogger::setSettingsObject( QSettings* settings )
+{
+#if LQTL_ENABLE_LOGGER_LOGGING
+    std::clog << FUNCTION_NAME
+            << " settings file \""
+            << ( settings?settings->fileName().toStdString().c_str():"(null)" ) << "\""
+            << std::endl;
+#endif
+
+    if ( settings )
+    {
+        this->settings = settings;
+        return true;
+    }
+
+    return false;
+}
+
+/** saves log levels for modules.
+ *
+ * saves also default log level with module name
+ * as set in QtLogger#defaultModuleLevel.
+ * levels inherited from parent modules are not saved.
+ *
+ * @return true if successfully saved<br>
+ *         false otherwise
+ */
+bool QtLogger::saveModuleLevels()
+{
+#if LQTL_ENABLE_LOGGER_LOGGING
+    std::clog << FUNCTION_NAME << std::endl;
+#endif
+
+    if ( settings )
+    {
+#if LQTL_ENABLE_LOGGER_LOGGING
+        std::clog << FUNCTION_NAME
+                << " using settings object"
+                << std::endl;
+#endif
+        settings->beginGroup( settingsSection );
+        settings->setValue( defaultModuleLevel, (int)(currentLevel) );
         mmMutex.lock();
-        moduleMap.insert( module, nmlvl );
+
+        QStringList names = registeredModules();
+        for ( int id = 0; id < moduleLevels.size() && id < names.size(); id++ )
+        {
+            const MODULE_LEVEL& mlvl = moduleLevels.at( id );
+            if ( mlvl.level == LL_STUB
+                 || mlvl.inherited
+            ) {
+                continue;
+            }
+
+#if LQTL_ENABLE_LOGGER_LOGGING
+            std::clog << FUNCTION_NAME
+                    << " module: \""
+                    << names.at( id ).toStdString() << "\""
+                    << " level: "
+                    << (int)(mlvl.level)
+                    << std::endl;
+#endif
+
+            settings->setValue( names.at( id ), (int)(mlvl.level) );
+        }
         mmMutex.unlock();
+        settings->endGroup();
+        settings->sync();
 
-        return lvl;
+        return true;
     }
 
-    return LL_STUB;
+#if LQTL_ENABLE_LOGGER_LOGGING
+        std::clog << FUNCTION_NAME
+                << " no settings object. log levels would not be saved"
+                << std::endl;
+#endif
+
+    return false;
 }
 
-/** retrieve log level for given module.
+/** loads log levels for modules from config.
  *
- * @param module module name
+ * if QtLogger#defaultModuleLevel found in config file
+ * resets QtLogger#currentLevel to its value
+ *
+ * @return true if successfully loaded<br>
+ *         false otherwise
+ */
+bool QtLogger::loadModuleLevels()
+{
+#if LQTL_ENABLE_LOGGER_LOGGING
+    std::clog << FUNCTION_NAME << std::endl;
+#endif
+
+    if ( settings )
+    {
+#if LQTL_ENABLE_LOGGER_LOGGING
+        std::clog << FUNCTION_NAME
+                << " using settings object"
+                << std::endl;
+#endif
+        applyModuleLevels( *settings );
+        settings->sync();
+
+        return true;
+    }
+
+#if LQTL_ENABLE_LOGGER_LOGGING
+        std::clog << FUNCTION_NAME
+                << " no settings object. log levels would not be loaded"
+                << std::endl;
+#endif
+    return false;
+}
+
+/** apply log levels for modules from settings.
+ *
+ * reads QtLogger#settingsSection group of passed settings,
+ * assigns levels as final ones and resets QtLogger#currentLevel
+ * if QtLogger#defaultModuleLevel found. modules whose levels
+ * were applied from settings before, but are not found anymore,
+ * inherit level from parent module again (the same way
+ * QtLogger#resetModuleLevel does).
+ *
+ * settings are read before QtLogger#mmMutex is locked. new
+ * levels table is built from copy of QtLogger#moduleLevels
+ * and swapped in at once, then inherited levels and threshold
+ * are recalculated once (see QtLogger#updateThresholdLevel),
+ * so call-site caches (see QtLogger#isModuleLevelEnabled)
+ * never resolve partially applied levels.
+ *
+ * @param source settings to read levels from
+ */
+void QtLogger::applyModuleLevels( QSettings& source )
+{
+    source.beginGroup( settingsSection );
+    QStringList keys = source.allKeys();
+
+    QList< int > ids;
+    QList< int > values;
+    int lastId = -1;
+    foreach ( const QString &key, keys )
+    {
+        int id = registerModule( key );
+        ids.append( id );
+        values.append( source.value( key, (int)LL_STUB ).toInt() );
+        lastId = qMax( lastId, id );
+    }
+    source.endGroup();
+
+    mmMutex.lock();
+
+    QVector< MODULE_LEVEL > levels = moduleLevels;
+    if ( lastId >= levels.size() )
+    {
+        int size = levels.size();
+        levels.resize( qMax( lastId + 1, size * 2 ) );
+        for ( int i = size; i < levels.size(); i++ )
+        {
+            levels[ i ] = noModuleLevel;
+        }
+    }
+
+    QVector< bool > applied( levels.size(), false );
+    LOG_LEVEL defaultLevel = currentLevel;
+    for ( int i = 0; i < ids.size(); i++ )
+    {
+        applied[ ids.at( i ) ] = true;
+
+        int value = values.at( i );
+        if ( value < 0
+             || value >= LL_STUB
+        ) {
+            value = currentLevel;
+
+#if LQTL_ENABLE_LOGGER_LOGGING
+            std::clog << FUNCTION_NAME
+                    << " incorrect log level of module \""
+                    << keys.at( i ).toStdString()
+                    << "\". set to default"
+                    << std::endl;
+#endif
+        }
+
+        MODULE_LEVEL& mlvl = levels[ ids.at( i ) ];
+        mlvl.level = (LOG_LEVEL)value;
+        mlvl.final = true;
+        mlvl.inherited = false;
+
+        if ( keys.at( i ) == defaultModuleLevel )
+        {
+            defaultLevel = (LOG_LEVEL)value;
+
+#if LQTL_ENABLE_LOGGER_LOGGING
+            std::clog << FUNCTION_NAME
+                    << " restored default log level: "
+                    << LQTL_QSTRINGCHAR( describeLogLevel( defaultLevel ) )
+                    << std::endl;
+#endif
+        }
+    }
+
+    foreach ( int id, settingsModules )
+    {
+        if ( id >= levels.size()
+             || applied.at( id )
+             || levels.at( id ).level == LL_STUB
+        ) {
+            continue;
+        }
+
+#if LQTL_ENABLE_LOGGER_LOGGING
+        std::clog << FUNCTION_NAME
+                << " module removed from settings: "
+                << id
+                << std::endl;
+#endif
+
+        MODULE_LEVEL& mlvl = levels[ id ];
+        mlvl.inherited = true;
+        mlvl.final = false;
+    }
+
+    moduleLevels = levels;
+    currentLevel = defaultLevel;
+    settingsModules = ids;
+    updateThresholdLevel();
+
+    mmMutex.unlock();
+}
+
+/** enable or disable reloading of log levels on settings file change.
+ *
+ * logger thread polls modification time and size of file
+ * of settings object (see QtLogger#setSettingsObject) with
+ * given interval and reloads levels (see QtLogger#applyModuleLevels)
+ * once they change. file is read with own settings object,
+ * so application settings object is not accessed from
+ * logger thread.
+ *
+ * modules removed from file inherit level from
+ * parent module again, default level is kept.
+ *
+ * @param interval polling interval, milliseconds, 0 to disable
+ *
+ * @return true if reloading enabled or disabled<br>
+ *         false if no settings object set
+ */
+bool QtLogger::setConfigReloadInterval( int interval )
+{
+#if LQTL_ENABLE_LOGGER_LOGGING
+    std::clog << FUNCTION_NAME
+            << " interval: "
+            << interval
+            << std::endl;
+#endif
+
+    if ( interval > 0 )
+    {
+        if ( !settings )
+        {
+#if LQTL_ENABLE_LOGGER_LOGGING
+            std::cerr << FUNCTION_NAME
+                    << " no settings object. log levels would not be reloaded"
+                    << std::endl;
+#endif
+            return false;
+        }
+
+        QFileInfo info( settings->fileName() );
+
+        rlMutex.lock();
+        reloadFile = settings->fileName();
+        reloadFormat = settings->format();
+        reloadModified = info.lastModified();
+        reloadSize = ( info.exists() ? info.size() : -1 );
+        reloadCheckTime = 0;
+        rlMutex.unlock();
+    }
+
+    reloadInterval.fetchAndStoreOrdered( qMax( interval, 0 ) );
+    wakeConsumer();
+
+    return true;
+}
+
+/** reload log levels if settings file changed.
+ *
+ * called from logger thread only, checks file
+ * no more often than QtLogger#reloadInterval.
+ */
+void QtLogger::checkConfigReload()
+{
+    int interval = reloadInterval;
+    if ( interval <= 0 )
+    {
+        return;
+    }
+
+    qint64 now = LogTimestamp::now();
+
+    rlMutex.lock();
+    if ( now < reloadCheckTime )
+    {
+        rlMutex.unlock();
+        return;
+    }
+    reloadCheckTime = now + (qint64)interval * 1000000;
+
+    QFileInfo info( reloadFile );
+    bool changed = ( info.exists()
+                     && ( info.lastModified() != reloadModified
+                          || info.size() != reloadSize ) );
+    if ( changed )
+    {
+        reloadModified = info.lastModified();
+        reloadSize = info.size();
+    }
+    QString file = reloadFile;
+    QSettings::Format format = reloadFormat;
+    rlMutex.unlock();
+
+    if ( !changed )
+    {
+        return;
+    }
+
+#if LQTL_ENABLE_LOGGER_LOGGING
+    std::clog << FUNCTION_NAME
+            << " reload \""
+            << file.toStdString()
+            << "\""
+            << std::endl;
+#endif
+
+    QSettings source( file, format );
+    applyModuleLevels( source );
+}
+
+/** retrieve log levels description
+ *
+ * @return #ll_string
+ */
+QStringList QtLogger::getLogLevelsDescription()
+{
+#if LQTL_ENABLE_LOGGER_LOGGING
+    std::clog << FUNCTION_NAME << std::endl;
+#endif
+
+    return ll_string;
+}
+
+/** retrieve current log levels for modules map
+ *
+ * @return copy of levels of modules having log level
+ *         record in #moduleLevels, mapped by module name
+ */
+QMap< QString, QtLogger::MODULE_LEVEL > QtLogger::getModulesMap()
+{
+#if LQTL_ENABLE_LOGGER_LOGGING
+    std::clog << FUNCTION_NAME << std::endl;
+#endif
+
+    QMap< QString, MODULE_LEVEL > ret;
+
+    mmMutex.lock();
+    QStringList names = registeredModules();
+    for ( int id = 0; id < moduleLevels.size() && id < names.size(); id++ )
+    {
+        if ( moduleLevels.at( id ).level != LL_STUB )
+        {
+            ret.insert( names.at( id ), moduleLevels.at( id ) );
+        }
+    }
+    mmMutex.unlock();
+
+    return ret;
+}
+
+/** log passed message.
+ *
+ * checks if passed log message level is lesser than
+ * assigned for module,
+ * if no loglevel for module record found - creates
+ * one inherited from parent module (see QtLogger#inheritModuleLevel)
+ * and checks if log messae level is lesser than it,
+ * passes message to QtLogger#write.
+ *
+ * @param level     message log level
+ * @param module    module name
+ * @param message   formed log message
+ * @param data      data to dump in hex if any
+ * @param datasz    size of data to dump
+ */
+void QtLogger::log(LOG_LEVEL level, const QString& module, QString message, const void* data, size_t datasz)
+{
+#if LQTL_ENABLE_LOGGER_LOGGING
+    std::clog << FUNCTION_NAME
+            << " lvl: " << ll_string[ (level>=LL_STUB || level<0)?LL_STUB:level ].toStdString()
+            << " module: \"" << module.toStdString() << "\""
+            << " msg: \"" << message.toStdString() << "\""
+            << std::endl;
+#endif
+
+    if ( level >= LL_STUB ||
+         level < 0
+    ) {
+#if LQTL_ENABLE_LOGGER_LOGGING
+        std::cerr << FUNCTION_NAME
+                << "incorrect log level"
+                << std::endl;
+#endif
+        return;
+    }
+
+    LOG_LEVEL moduleLevel = inheritModuleLevel( registerModule( module ), module );
+    if ( level > moduleLevel )
+    {
+#if LQTL_ENABLE_LOGGER_LOGGING
+        std::clog << FUNCTION_NAME
+                << " log message rejected: moduleLevel: "
+                << ll_string[ moduleLevel ].toStdString()
+                << std::endl;
+#endif
+        return;
+    }
+
+    write( level, message, data, datasz );
+}
+
+/** pass message to logger thread.
+ *
+ * does not check log level, so it should be
+ * checked by caller (i.e. QtLogger#log or
+ * QtLogger#isModuleLevelEnabled).
+ *
+ * converts passed data into hex string (if any) and
+ * appends it to log message, stamps record with time of call,
+ * enqueues passed log message into QtLogger#messageRing
+ * and wakesup QtLogger#run thread.
+ *
+ * @param level     message log level
+ * @param message   formed log message
+ * @param data      data to dump in hex if any
+ * @param datasz    size of data to dump
+ */
+void QtLogger::write( LOG_LEVEL level, QString message, const void* data, size_t datasz )
+{
+    // merged with records of other threads by time of call
+    // (see LogRecordMerger), so stamped before hex dump
+    qint64 timestamp = LogTimestamp::now();
+
+    if ( data
+         && datasz > 0
+    ) {
+        message.append( hexData( data, datasz ) );
+    }
+
+    LogRecord record;
+    record.level = level;
+    record.timestamp = timestamp;
+    record.message = message;
+    stampSequence( record );
+
+    enqueue( record );
+}
+
+/** form log message and pass it to logger thread.
+ *
+ * overloaded function.
+ * does not check log level, so it should be
+ * checked by caller (i.e. QtLogger#isModuleLevelEnabled).
+ *
+ * if QtLogger#deferredFormatting is set -- only copies
+ * passed arguments into stack buffer (see LogRecord#captureArguments)
+ * and references dumped data, both are copied straight into ring,
+ * message formed later on logger thread by QtLogger#formatRecord.
+ * otherwise forms message right here.
+ *
+ * @param level     message log level
+ * @param file      source file name (__FILE__)
+ * @param line      source line number (__LINE__)
+ * @param function  function signature (#FUNCTION_NAME)
+ * @param data      data to dump in hex if any
+ * @param datasz    size of data to dump
+ * @param fmt       message format, must be string literal
+ * @param ...       arguments for fmt
+ */
+void QtLogger::write( LOG_LEVEL level,
+                      const char* file, int line, const char* function,
+                      const void* data, size_t datasz,
+                      const char* fmt, ... )
+{
+    LogRecord record;
+    record.level = level;
+    record.timestamp = LogTimestamp::now();
+    record.file = file;
+    record.line = line;
+    record.function = function;
+
+    ProducerContext* context = ProducerContext::current();
+    record.threadId = context->threadId;
+    record.threadTag = context->threadTag;
+    stampSequence( record );
+
+    LogRecord::CAPTURE_BUFFER capture;
+    va_list ap;
+    va_start( ap, fmt );
+    if ( deferredFormatting )
+    {
+        record.captureArguments( fmt, ap, capture );
+
+        if ( data
+             && datasz > 0
+        ) {
+            record.referenceData( data, datasz );
+        }
+    }
+    else
+    {
+        formatPrefix( record, context->buffer, record.message );
+        record.message.append( QString().vsprintf( fmt, ap ) );
+
+        if ( data
+             && datasz > 0
+        ) {
+            record.message.append( hexData( data, datasz ) );
+        }
+    }
+    va_end( ap );
+
+    enqueue( record );
+}
+
+/** form log message with '{}'-style format and pass it to logger thread.
+ *
+ * overloaded function.
+ * does not check log level, so it should be
+ * checked by caller (i.e. QtLogger#isModuleLevelEnabled).
+ *
+ * if QtLogger#deferredFormatting is set -- only copies
+ * passed arguments into LogRecord, otherwise forms message
+ * right here with LogArgument#format.
+ *
+ * @param level     message log level
+ * @param file      source file name (__FILE__)
+ * @param line      source line number (__LINE__)
+ * @param function  function signature (#FUNCTION_NAME)
+ * @param data      data to dump in hex if any
+ * @param datasz    size of data to dump
+ * @param fmt       message format, must be string literal
+ * @param args      arguments for fmt
+ * @param count     number of arguments
+ */
+void QtLogger::write( LOG_LEVEL level,
+                      const char* file, int line, const char* function,
+                      const void* data, size_t datasz,
+                      const char* fmt, const LogArgument* args, int count )
+{
+    LogRecord record;
+    record.level = level;
+    record.timestamp = LogTimestamp::now();
+    record.file = file;
+    record.line = line;
+    record.function = function;
+
+    ProducerContext* context = ProducerContext::current();
+    record.threadId = context->threadId;
+    record.threadTag = context->threadTag;
+    stampSequence( record );
+
+    LogRecord::CAPTURE_BUFFER capture;
+    if ( deferredFormatting )
+    {
+        record.captureArguments( fmt, args, count, capture );
+
+        if ( data
+             && datasz > 0
+        ) {
+            record.referenceData( data, datasz );
+        }
+    }
+    else
+    {
+        formatPrefix( record, context->buffer, record.message );
+        record.message.append( LogArgument::format( fmt, args, count ) );
+
+        if ( data
+             && datasz > 0
+        ) {
+            record.message.append( hexData( data, datasz ) );
+        }
+    }
+
+    enqueue( record );
+}
+
+/** number log record if priority lane is enabled.
+ *
+ * messages of priority lane may be written before
+ * previously logged less important ones, so
+ * LogRecord#sequence printed with message allows to restore
+ * original order.
+ *
+ * @param record log record
+ */
+void QtLogger::stampSequence( LogRecord& record )
+{
+    if ( (int)priorityLevel >= 0 )
+    {
+        record.sequence = (quint32)messageSequence.fetchAndAddRelaxed( 1 ) + 1;
+    }
+}
+
+/** enqueue log record.
+ *
+ * pushes passed log record into QtLogger#priorityRing if it
+ * is important enough (see QtLogger#setPriorityLane), into
+ * ring selected by QtLogger#setQueueEngine otherwise and wakes
+ * up QtLogger#run thread if it sleeps.
+ *
+ * does not lock anything while ring has free space.
+ * if ring is full (see QtLogger#setQueueCapacity) -- acts
+ * according to QtLogger#setOverflowPolicy: drops record,
+ * discards the oldest queued record or waits until logger
+ * thread frees space (see QtLogger#waitForSpace).
+ *
+ * record larger than half of thread ring goes to QtLogger#messageRing,
+ * record larger than half of QtLogger#messageRing is dropped.
+ *
+ * @param record log record
+ */
+void QtLogger::enqueue( const LogRecord& record )
+{
+    int maxRecords = queueMessagesLimit;
+    int maxBytes = queueBytesLimit;
+
+    LogRingBuffer* ring = &messageRing;
+    if ( record.level <= (int)priorityLevel )
+    {
+        // queue limits do not apply to priority lane
+        ring = &priorityRing;
+        maxRecords = 0;
+        maxBytes = 0;
+    }
+    else if ( (int)queueEngine == QE_THREAD_RINGS )
+    {
+        ring = threadRing();
+        if ( !ring->fits( record ) )
+        {
+            ring = &messageRing;
+        }
+    }
+
+    if ( !ring->fits( record ) )
+    {
+#if LQTL_ENABLE_LOGGER_LOGGING
+        std::cerr << FUNCTION_NAME
+                << " record too large: "
+                << record.serializedSize()
+                << std::endl;
+#endif
+        countDropped( record.level );
+        return;
+    }
+
+    while ( !ring->tryPush( record, maxRecords, maxBytes ) )
+    {
+        int policy = overflowPolicy;
+        if ( policy == OP_DROP_NEWEST
+             || ( policy == OP_DROP_BELOW_LEVEL
+                  && record.level > (int)overflowLevel )
+        ) {
+            countDropped( record.level );
+            return;
+        }
+
+        if ( policy == OP_DROP_OLDEST
+             && discardOldest( ring )
+        ) {
+            continue;
+        }
+
+        if ( !waitForSpace( ring, record, maxRecords, maxBytes ) )
+        {
+            countDropped( record.level );
+            return;
+        }
+        break;
+    }
+
+    // ordered store of record header in tryPush
+    // orders this read after publishing record
+    if ( (int)consumerWaiting )
+    {
+        wakeConsumer();
+    }
+}
+
+/** wait until record fits into full ring and push it.
+ *
+ * wakes logger thread up if it is parked and sleeps on
+ * QtLogger#spaceWait until logger thread pops records
+ * (see QtLogger#wakeProducers). QtLogger#producersWaiting
+ * is incremented before ring is checked again, so space
+ * freed concurrently either is seen by the check or
+ * logger thread sees the counter and wakes producer up.
+ *
+ * gives up once logging is finished (see QtLogger#finishLogging):
+ * nobody frees space anymore.
+ *
+ * @param ring          full ring
+ * @param record        log record
+ * @param maxRecords    records limit passed to LogRingBuffer#tryPush
+ * @param maxBytes      bytes limit passed to LogRingBuffer#tryPush
+ *
+ * @return true if record pushed<br>
+ *         false if logging is finished
+ */
+bool QtLogger::waitForSpace( LogRingBuffer* ring, const LogRecord& record, int maxRecords, int maxBytes )
+{
+    if ( (int)consumerWaiting )
+    {
+        wakeConsumer();
+    }
+
+    spaceMutex.lock();
+    producersWaiting.ref();
+    bool pushed = ring->tryPush( record, maxRecords, maxBytes );
+    while ( !pushed
+            && !shutdown
+    ) {
+        spaceWait.wait( &spaceMutex );
+        pushed = ring->tryPush( record, maxRecords, maxBytes );
+    }
+    producersWaiting.deref();
+    spaceMutex.unlock();
+
+    return pushed;
+}
+
+/** wake up producers waiting for free space.
+ *
+ * called by logger thread after popping records
+ * and on shutdown, locks QtLogger#spaceMutex only
+ * if any producer waits (see QtLogger#waitForSpace).
+ */
+void QtLogger::wakeProducers()
+{
+    if ( (int)producersWaiting )
+    {
+        spaceMutex.lock();
+        spaceWait.wakeAll();
+        spaceMutex.unlock();
+    }
+}
+
+/** discard the oldest record of the ring.
+ *
+ * locks QtLogger#popMutex to pop record
+ * concurrently with logger thread.
+ *
+ * @param ring full ring
+ *
+ * @return true if record discarded<br>
+ *         false if ring is empty
+ */
+bool QtLogger::discardOldest( LogRingBuffer* ring )
+{
+    LogRecord oldest;
+
+    popMutex.lock();
+    bool popped = ring->pop( oldest );
+    popMutex.unlock();
+
+    if ( popped )
+    {
+        countDropped( oldest.level );
+    }
+
+    return popped;
+}
+
+/** count dropped message.
+ *
+ * @param level dropped message level
+ */
+void QtLogger::countDropped( int level )
+{
+    droppedMessages[ ( level >= 0 && level < LL_STUB ) ? level : LL_STUB ].ref();
+    droppedTotal.ref();
+}
+
+/** wake up logger thread.
+ *
+ * locks QtLogger#mqMutex, so wake up is not lost if logger thread
+ * is between checking QtLogger#messageRing and going to sleep.
+ */
+void QtLogger::wakeConsumer()
+{
+    mqMutex.lock();
+    mqWait.wakeOne();
+    mqMutex.unlock();
+}
+
+/** get ring of current thread.
+ *
+ * creates ring on first call from the thread, stores it
+ * in ProducerContext#rings and passes it to logger thread
+ * through QtLogger#newThreadRings.
+ *
+ * @return ring of current thread
+ */
+LogRingBuffer* QtLogger::threadRing()
+{
+    ProducerContext* context = ProducerContext::current();
+
+    LogRingBuffer* ring = context->ring( instanceId );
+    if ( !ring )
+    {
+        ring = new LogRingBuffer( THREAD_RING_CAPACITY );
+        // one reference for producer context, one for logger thread
+        ring->acquire();
+
+        trMutex.lock();
+        newThreadRings.append( ring );
+        threadRingsGeneration.fetchAndAddOrdered( 1 );
+        trMutex.unlock();
+
+        context->rings.append( qMakePair( (int)instanceId, ring ) );
+    }
+
+    return ring;
+}
+
+/** pass per-thread rings created since last call to merger.
+ *
+ * called from logger thread only.
+ *
+ * @param merger        logger thread merger
+ * @param generation    QtLogger#threadRingsGeneration seen by last call
+ */
+void QtLogger::adoptThreadRings( LogRecordMerger& merger, int& generation )
+{
+    if ( (int)threadRingsGeneration == generation )
+    {
+        return;
+    }
+
+    trMutex.lock();
+    generation = threadRingsGeneration;
+    while ( !newThreadRings.isEmpty() )
+    {
+        merger.addSource( newThreadRings.takeFirst(), true );
+    }
+    trMutex.unlock();
+
+#if LQTL_ENABLE_LOGGER_LOGGING
+    std::clog << FUNCTION_NAME
+            << " rings: "
+            << merger.sourcesCount()
+            << std::endl;
+#endif
+}
+
+/** enable or disable deferred message formatting.
+ *
+ * when enabled QtLogger#write copies only format pointer,
+ * timestamp, level and raw format arguments at call site,
+ * message is formed on logger thread. format arguments
+ * should not rely on being formatted at call site
+ * (i.e. pointers passed with %p are printed, not dereferenced,
+ * strings passed with %s are copied).
+ *
+ * disabled by default.
+ *
+ * @param enable deferred formatting flag
+ */
+void QtLogger::setDeferredFormatting( bool enable )
+{
+#if LQTL_ENABLE_LOGGER_LOGGING
+    std::clog << FUNCTION_NAME
+            << " enable: "
+            << ( enable?"T":"f" )
+            << std::endl;
+#endif
+
+    deferredFormatting = enable;
+}
+
+/** set message timestamp format.
+ *
+ * default format is hh:mm:ss.zzz (milliseconds, no date).
+ *
+ * @param precision number of fraction of second digits
+ * @param withDate  prepend time with date (yyyy-MM-dd)
+ */
+void QtLogger::setTimestampFormat( LogTimestamp::PRECISION precision, bool withDate )
+{
+#if LQTL_ENABLE_LOGGER_LOGGING
+    std::clog << FUNCTION_NAME
+            << " precision: "
+            << precision
+            << " date: "
+            << ( withDate?"T":"f" )
+            << std::endl;
+#endif
+
+    timestampPrecision = precision;
+    timestampDate = withDate;
+}
+
+/** set name of current thread.
+ *
+ * name is shown instead of thread id in prefix of
+ * messages logged from current thread afterwards
+ * (see ProducerContext#setName).
+ *
+ * @param name thread name, empty to show thread id again
+ */
+void QtLogger::setThreadName( const QString& name )
+{
+#if LQTL_ENABLE_LOGGER_LOGGING
+    std::clog << FUNCTION_NAME
+            << " name: "
+            << name.toStdString()
+            << std::endl;
+#endif
+
+    ProducerContext::current()->setName( name );
+}
+
+/** select message queue engine.
+ *
+ * QE_SHARED_RING (default): all threads push records into
+ * single lock-free ring.
+ *
+ * QE_THREAD_RINGS: each thread pushes records into its own
+ * ring, so producers do not contend for shared ring position.
+ * logger thread merges rings by record timestamp: order of each
+ * thread messages is kept, messages of different threads are
+ * ordered correctly unless published later than skew window
+ * after their timestamp. larger window gives more exact order
+ * at cost of messages delay when not all threads are logging.
+ *
+ * may be switched at any moment, records already queued
+ * are not lost.
+ *
+ * @param engine    queue engine
+ * @param skew      skew window of QE_THREAD_RINGS merge, microseconds
+ */
+void QtLogger::setQueueEngine( QUEUE_ENGINE engine, int skew )
+{
+#if LQTL_ENABLE_LOGGER_LOGGING
+    std::clog << FUNCTION_NAME
+            << " engine: "
+            << engine
+            << " skew: "
+            << skew
+            << std::endl;
+#endif
+
+    mergeSkew.fetchAndStoreOrdered( qMax( skew, 0 ) );
+    queueEngine.fetchAndStoreOrdered( engine );
+}
+
+/** limit message queue size.
+ *
+ * limits apply to QtLogger#messageRing and to each
+ * per-thread ring (see QtLogger#setQueueEngine) and can not
+ * exceed ring size (LogRingBuffer#DEFAULT_CAPACITY and
+ * #THREAD_RING_CAPACITY bytes). messages limit is approximate:
+ * concurrent producers may exceed it by their number.
+ *
+ * bytes limit applies to queued messages: message larger
+ * than limit is queued once queue is empty. message larger
+ * than half of ring size is dropped regardless of limits
+ * (counted by QtLogger#getDroppedMessages), per-thread ring
+ * falls back to QtLogger#messageRing for it.
+ *
+ * what happens when queue is full is selected by
+ * QtLogger#setOverflowPolicy.
  *
- * @return mdule log level structure if log level already assigned to module<br>
- *         NULL if no module found.
+ * @param messages  maximum number of queued messages, 0 for no limit
+ * @param bytes     maximum size of queued messages, 0 for ring size
  */
-const QtLogger::MODULE_LEVEL* QtLogger::getModuleLevel( QString module )
+void QtLogger::setQueueCapacity( int messages, int bytes )
 {
 #if LQTL_ENABLE_LOGGER_LOGGING
     std::clog << FUNCTION_NAME
-            << " module: "
-            << module.toStdString()
+            << " messages: "
+            << messages
+            << " bytes: "
+            << bytes
             << std::endl;
 #endif
 
-    const MODULE_LEVEL* ret;
-
-    mmMutex.lock();
-    ret = moduleMap.value( module, NULL );
-    mmMutex.unlock();
-
-    return ret;
+    queueMessagesLimit.fetchAndStoreOrdered( qMax( messages, 0 ) );
+    queueBytesLimit.fetchAndStoreOrdered( qMax( bytes, 0 ) );
 }
 
-/** set main-application settings object.
+/** select what to do with message when queue is full.
  *
- * should be set before QtLogger#saveModuleLevels
- * or Qtlogger#loadModuleLevels invoked
+ * OP_BLOCK (default): producer waits until logger thread
+ * frees space.<br>
+ * OP_DROP_NEWEST: message is dropped.<br>
+ * OP_DROP_OLDEST: the oldest queued message is dropped.<br>
+ * OP_DROP_BELOW_LEVEL: message less important than level is
+ * dropped, producer of more important one waits.
  *
- * @param settings main-application settings object
+ * dropped messages are counted per level
+ * (see QtLogger#getDroppedMessages) and reported into log.
  *
- * @return true if settings object not NULL<br>
- *         false otherwise
+ * @param policy    overflow policy
+ * @param level     the least important level kept by OP_DROP_BELOW_LEVEL
  */
-bool QtLogger::setSettingsObject( QSettings* settings )
+void QtLogger::setOverflowPolicy( OVERFLOW_POLICY policy, LOG_LEVEL level )
 {
 #if LQTL_ENABLE_LOGGER_LOGGING
     std::clog << FUNCTION_NAME
-            << " settings file \""
-            << ( settings?settings->fileName().toStdString().c_str():"(null)" ) << "\""
+            << " policy: "
+            << policy
+            << " level: "
+            << ll_string[ (level>=LL_STUB || level<0)?LL_STUB:level ].toStdString()
             << std::endl;
 #endif
 
-    if ( settings )
-    {
-        this->settings = settings;
-        return true;
-    }
-
-    return false;
+    overflowLevel.fetchAndStoreOrdered( level );
+    overflowPolicy.fetchAndStoreOrdered( policy );
 }
 
-/** saves log levels for modules.
+/** wait until queued messages are written.
  *
- * saves also default log level with module name
- * as set in QtLogger#defaultModuleLevel.
+ * blocks until every message enqueued before the call is passed
+ * to all log writers and writers are flushed
+ * (see LogWriterInterface#flush), or until timeout expires.
  *
- * @return true if successfully saved<br>
- *         false otherwise
+ * takes next flush request sequence number and wakes up logger
+ * thread, which drains queue, flushes writers and reports the
+ * latest request it served. does not poll.
+ *
+ * must not be called from log writers (i.e. from logger thread).
+ *
+ * @param timeout maximum wait time, milliseconds, negative to wait forever
+ *
+ * @return true if messages are written<br>
+ *         false on timeout or if logger thread is not running
  */
-bool QtLogger::saveModuleLevels()
+bool QtLogger::flush( int timeout )
 {
 #if LQTL_ENABLE_LOGGER_LOGGING
-    std::clog << FUNCTION_NAME << std::endl;
+    std::clog << FUNCTION_NAME
+            << " timeout: "
+            << timeout
+            << std::endl;
 #endif
 
-    if ( settings )
-    {
-#if LQTL_ENABLE_LOGGER_LOGGING
-        std::clog << FUNCTION_NAME
-                << " using settings object"
-                << std::endl;
-#endif
-        settings->beginGroup( settingsSection );
-        settings->setValue( defaultModuleLevel, (int)(currentLevel) );
-        mmMutex.lock();
+    if ( QThread::currentThread() == this
+         || !isRunning()
+    ) {
+        return false;
+    }
 
-        QMapIterator< QString, MODULE_LEVEL* > iter( moduleMap );
-        while ( iter.hasNext() )
-        {
-            iter.next();
+    int sequence = flushRequested.fetchAndAddOrdered( 1 ) + 1;
+    wakeConsumer();
 
-#if LQTL_ENABLE_LOGGER_LOGGING
-            std::clog << FUNCTION_NAME
-                    << " module: \""
-                    << iter.key().toStdString() << "\""
-                    << " level: "
-                    << (int)(iter.value()->level)
-                    << std::endl;
-#endif
+    qint64 deadline = LogTimestamp::now() + (qint64)timeout * 1000000;
 
-            settings->setValue( iter.key(), (int)(iter.value()->level) );
+    flushMutex.lock();
+    // sequence numbers may wrap
+    while ( (int)( (uint)(int)flushCompleted - (uint)sequence ) < 0 )
+    {
+        if ( timeout < 0 )
+        {
+            flushWait.wait( &flushMutex );
+            continue;
         }
-        mmMutex.unlock();
-        settings->endGroup();
-        settings->sync();
 
-        return true;
+        qint64 remaining = ( deadline - LogTimestamp::now() ) / 1000000;
+        if ( remaining <= 0
+             || !flushWait.wait( &flushMutex, (unsigned long)remaining )
+        ) {
+            break;
+        }
     }
+    bool completed = ( (int)( (uint)(int)flushCompleted - (uint)sequence ) >= 0 );
+    flushMutex.unlock();
 
 #if LQTL_ENABLE_LOGGER_LOGGING
-        std::clog << FUNCTION_NAME
-                << " no settings object. log levels would not be saved"
-                << std::endl;
+    std::clog << FUNCTION_NAME
+            << " completed: "
+            << ( completed?"T":"f" )
+            << std::endl;
 #endif
 
-    return false;
+    return completed;
 }
 
-/** loads log levels for modules from config.
+/** set level of messages written through writer buffers.
  *
- * if QtLogger#defaultModuleLevel found in config file
- * resets QtLogger#currentLevel to its value
+ * once batch containing message of given level or more
+ * important one is written, logger thread syncs writers
+ * (see LogWriterInterface#sync), so buffering writers
+ * (i.e. #FileAppender with buffer size set) write it out
+ * right away instead of waiting for logger thread to idle.
  *
- * @return true if successfully loaded<br>
- *         false otherwise
+ * LL_ERROR by default.
+ *
+ * @param level the least important level synced right away,
+ *              LL_STUB or negative to sync on idle only
  */
-bool QtLogger::loadModuleLevels()
+void QtLogger::setFlushLevel( LOG_LEVEL level )
 {
 #if LQTL_ENABLE_LOGGER_LOGGING
-    std::clog << FUNCTION_NAME << std::endl;
-#endif
-
-    if ( settings )
-    {
-#if LQTL_ENABLE_LOGGER_LOGGING
-        std::clog << FUNCTION_NAME
-                << " using settings object"
-                << std::endl;
+    std::clog << FUNCTION_NAME
+            << " level: "
+            << ll_string[ (level>=LL_STUB || level<0)?LL_STUB:level ].toStdString()
+            << std::endl;
 #endif
-        settings->beginGroup( settingsSection );
-        QStringList keys = settings->allKeys();
-        mmMutex.lock();
 
-        foreach ( const QString &key, keys )
-        {
-            setModuleLevel( key,
-                            (LOG_LEVEL)(settings->value( key, currentLevel ).toInt()),
-                            true
-                          );
+    flushLevel.fetchAndStoreOrdered( ( level >= LL_STUB || level < 0 ) ? -1 : (int)level );
+}
 
-            if ( key == defaultModuleLevel )
-            {
-                currentLevel = (LOG_LEVEL)settings->value( key, currentLevel ).toInt();
+/** install handler writing pending messages on fatal signals.
+ *
+ * see CrashHandler for details. messages are written
+ * unformatted, in producer ring order.
+ *
+ * @param path file to write pending messages to
+ *
+ * @return true if handler installed
+ */
+bool QtLogger::installCrashHandler( const QString& path )
+{
+    return CrashHandler::install( path );
+}
 
+/** enable or disable priority lane.
+ *
+ * messages of given level and more important ones are
+ * passed through separate queue, which logger thread drains
+ * before other messages and syncs log writers right after
+ * (see LogWriterInterface#sync),
+ * so they are not delayed by queued less important messages.
+ * queue capacity limits (see QtLogger#setQueueCapacity)
+ * are not applied to priority lane.
+ *
+ * while lane is enabled messages are numbered: number is
+ * printed after timestamp, i.e. "#1234", so original order
+ * may be restored from log.
+ *
+ * disabled by default.
+ *
+ * @param enable    priority lane flag
+ * @param level     the least important level passed through lane
+ */
+void QtLogger::setPriorityLane( bool enable, LOG_LEVEL level )
+{
 #if LQTL_ENABLE_LOGGER_LOGGING
-                std::clog << FUNCTION_NAME
-                        << " restored default log level: "
-                        << LQTL_QSTRINGCHAR( describeLogLevel( currentLevel ) )
-                        << std::endl;
+    std::clog << FUNCTION_NAME
+            << " enable: "
+            << ( enable?"T":"f" )
+            << " level: "
+            << ll_string[ (level>=LL_STUB || level<0)?LL_STUB:level ].toStdString()
+            << std::endl;
 #endif
-            }
-        }
-
-        mmMutex.unlock();
-        settings->endGroup();
-        settings->sync();
-
-        return true;
-    }
 
-#if LQTL_ENABLE_LOGGER_LOGGING
-        std::clog << FUNCTION_NAME
-                << " no settings object. log levels would not be loaded"
-                << std::endl;
-#endif
-    return false;
+    priorityLevel.fetchAndStoreOrdered( enable ? (int)level : -1 );
 }
 
-/** retrieve log levels description
+/** request logger thread to reopen all log writers.
  *
- * @return #ll_string
+ * see LogWriterInterface#reopen. returns immediately,
+ * QtLogger#flush called after this one returns once
+ * writers are reopened.
  */
-QStringList QtLogger::getLogLevelsDescription()
+void QtLogger::reopenWriters()
 {
 #if LQTL_ENABLE_LOGGER_LOGGING
     std::clog << FUNCTION_NAME << std::endl;
 #endif
 
-    return ll_string;
+    reopenRequested.ref();
+    wakeConsumer();
 }
 
-/** retrieve current log levels for modules map
+/** retrieve queue and throughput statistics.
+ *
+ * keys are:<br>
+ * "uptime" -- time since logger construction, milliseconds<br>
+ * "written" -- messages passed to writers<br>
+ * "queued" -- messages in shared queue (per-thread rings not counted)<br>
+ * "queued_priority" -- messages in priority lane<br>
+ * "queue_capacity" -- shared queue size, bytes<br>
+ * "dropped" -- total number of dropped messages<br>
+ * "dropped_{level}" -- number of dropped messages of level
+ * (see QtLogger#getDroppedMessages)
  *
- * @return #moduleMap
+ * @return statistics values by name
  */
-QMap< QString, QtLogger::MODULE_LEVEL* > QtLogger::getModulesMap()
+QMap< QString, qint64 > QtLogger::getStatistics()
 {
-#if LQTL_ENABLE_LOGGER_LOGGING
-    std::clog << FUNCTION_NAME << std::endl;
-#endif
+    QMap< QString, qint64 > stats;
+
+    stats.insert( "uptime", ( LogTimestamp::now() - startTime ) / 1000000 );
+    stats.insert( "written", (quint32)(int)writtenMessages );
+    stats.insert( "queued", messageRing.size() );
+    stats.insert( "queued_priority", priorityRing.size() );
+    stats.insert( "queue_capacity", messageRing.capacity() );
+    stats.insert( "dropped", (int)droppedTotal );
+    for ( int i = 0; i < LL_STUB; i++ )
+    {
+        stats.insert( QString( "dropped_%1" ).arg( ll_string[ i ].trimmed() ),
+                      (int)droppedMessages[ i ] );
+    }
 
-    return moduleMap;
+    return stats;
 }
 
-/** log passed message.
+/** start control endpoint.
  *
- * checks if passed log message level is lesser than
- * assigned for module,
- * if no loglevel for module record found - creates
- * one with QtLogger#currentLevel and checks if
- * log messae level is lesser than
- * QtLogger#currentLevel,
- * converts passed data into hex string (if any) and
- * appends it to log message,
- * enqueues passed log message into QtLogger#messageQueue
- * and wakesup QtLogger#run thread.
+ * see ControlServer. replaces running one.
  *
- * @param level     message log level
- * @param module    module name
- * @param message   formed log message
- * @param data      data to dump in hex if any
- * @param datasz    size of data to dump
+ * @param path control socket path
+ *
+ * @return true if server listens on socket<br>
+ *         false otherwise (i.e. platform is not supported)
  */
-void QtLogger::log(LOG_LEVEL level, QString module, QString message, const void* data, size_t datasz)
+bool QtLogger::startControlServer( const QString& path )
 {
 #if LQTL_ENABLE_LOGGER_LOGGING
     std::clog << FUNCTION_NAME
-            << " lvl: " << ll_string[ (level>=LL_STUB || level<0)?LL_STUB:level ].toStdString()
-            << " module: \"" << module.toStdString() << "\""
-            << " msg: \"" << message.toStdString() << "\""
+            << " path: "
+            << path.toStdString()
             << std::endl;
 #endif
 
-    if ( level >= LL_STUB ||
-         level < 0
-    ) {
-#if LQTL_ENABLE_LOGGER_LOGGING
-        std::cerr << FUNCTION_NAME
-                << "incorrect log level"
-                << std::endl;
-#endif
-        return;
+    stopControlServer();
+
+    ControlServer* server = new ControlServer( *this, path );
+    if ( !server->isListening() )
+    {
+        delete server;
+        return false;
     }
 
-    bool checkCurrentLogLevel = true;
+    csMutex.lock();
+    controlServer = server;
+    csMutex.unlock();
 
-    const MODULE_LEVEL* mlvl = getModuleLevel( module );
-    if ( mlvl
-         && level > mlvl->level
-    ) {
+    return true;
+}
+
+/** stop control endpoint if started.
+ */
+void QtLogger::stopControlServer()
+{
+    csMutex.lock();
+    ControlServer* server = controlServer;
+    controlServer = NULL;
+    csMutex.unlock();
+
+    delete server;
+}
+
+/** set logger thread polling time before parking.
+ *
+ * when rings get empty logger thread keeps polling them
+ * yielding processor up to given time before going to sleep
+ * on QtLogger#mqWait. actual polling time adapts: it is halved
+ * (down to 1/16 of given time) each time polling finds nothing
+ * and restored once records arrive while polling.
+ *
+ * @param spin polling time, microseconds, 0 to park immediately
+ */
+void QtLogger::setConsumerSpin( int spin )
+{
 #if LQTL_ENABLE_LOGGER_LOGGING
-        std::clog << FUNCTION_NAME
-                << " log message rejected: moduleLevel: "
-                << ll_string[ mlvl->level ].toStdString()
-                << std::endl;
+    std::clog << FUNCTION_NAME
+            << " spin: "
+            << spin
+            << std::endl;
 #endif
-        return;
-    }
-    else if ( !mlvl )
-    {
-        // set default log level for unknown module
-        setModuleLevel( module, currentLevel );
-    }
-    else
+
+    consumerSpin.fetchAndStoreOrdered( qMax( spin, 0 ) );
+}
+
+/** get number of dropped messages.
+ *
+ * @param level message level, #LL_STUB for messages
+ *              of unknown level
+ *
+ * @return number of messages of given level dropped
+ *         since logger start
+ */
+int QtLogger::getDroppedMessages( LOG_LEVEL level )
+{
+    return droppedMessages[ ( level >= 0 && level < LL_STUB ) ? level : LL_STUB ];
+}
+
+/** form log message prefix.
+ *
+ * {current_time}[ #{sequence}] {log_level-string} {filename}:{line_number} [{thread_tag}] {function_signature}
+ *
+ * {current_time} formatted according to QtLogger#setTimestampFormat,
+ * {sequence} is LogRecord#sequence printed while priority lane
+ * is enabled (see QtLogger#setPriorityLane),
+ * {thread_tag} is thread name set by QtLogger#setThreadName
+ * or thread id.
+ *
+ * prefix is formatted into passed buffer (normally
+ * ProducerContext#buffer of current thread) which grows
+ * only if prefix does not fit, then converted into message
+ * with space reserved for the rest of message.
+ *
+ * @param record    log record
+ * @param buffer    reusable formatting buffer
+ * @param message   string to append prefix to
+ */
+void QtLogger::formatPrefix( const LogRecord& record, QByteArray& buffer, QString& message )
+{
+    char timestamp[ LogTimestamp::MAX_LENGTH ];
+    LogTimestamp::format( record.timestamp, timestampPrecision, timestampDate, timestamp );
+
+    char sequence[ 16 ] = "";
+    if ( record.sequence )
     {
-        checkCurrentLogLevel = false;
+        snprintf( sequence, sizeof( sequence ), " #%u", (unsigned int)record.sequence );
     }
 
+    int level = ( record.level >= 0 && record.level <= LL_STUB ) ? record.level : LL_STUB;
+    const char* file = ( record.file ? LQTL_FILENAME_FROM_PATH( record.file ) : "" );
+    const char* function = ( record.function ? record.function : "" );
 
-    if ( checkCurrentLogLevel
-         && level > currentLevel )
+    int length = 0;
+    for ( int pass = 0; pass < 2; pass++ )
     {
-#if LQTL_ENABLE_LOGGER_LOGGING
-        std::clog << FUNCTION_NAME
-                << " log message rejected: currentLevel: "
-                << ll_string[ currentLevel ].toStdString()
-                << std::endl;
-#endif
-        return;
+        length = snprintf( buffer.data(), buffer.size(),
+                           "%s%s %s %16s:%-5d\t[%s] %s",
+                           timestamp,
+                           sequence,
+                           ll_latin1[ level ].constData(),
+                           file,
+                           record.line,
+                           record.threadTag.constData(),
+                           function
+                         );
+
+        if ( length < buffer.size() )
+        {
+            break;
+        }
+        buffer.resize( length + 1 );
     }
 
-    if ( data
-         && datasz > 0
-    ) {
-        message.append( hexData( data, datasz ) );
-    }
+    message.reserve( message.size() + length + ProducerContext::BUFFER_SIZE );
+    message.append( QLatin1String( buffer.constData() ) );
+}
 
-    mqMutex.lock();
-    messageQueue.enqueue( message );
+/** form message reported by logger itself.
+ *
+ * prepends the same prefix log messages get (see
+ * QtLogger#formatPrefix) with current time and tag of
+ * calling thread, so reports like number of dropped
+ * messages (see QtLogger#appendDropSummary) look like
+ * regular log messages.
+ *
+ * @param level message log level
+ * @param text  message text
+ *
+ * @return formatted message
+ */
+QString QtLogger::formatNotice( LOG_LEVEL level, const QString& text )
+{
+    ProducerContext* context = ProducerContext::current();
 
-#if LQTL_ENABLE_LOGGER_LOGGING
-    std::clog << FUNCTION_NAME
-            << " message queue size: "
-            << messageQueue.size()
-            << std::endl;
-#endif
+    LogRecord notice;
+    notice.level = level;
+    notice.timestamp = LogTimestamp::now();
+    notice.threadTag = context->threadTag;
 
-    mqWait.wakeAll();
-    mqMutex.unlock();
+    QString message;
+    formatPrefix( notice, context->buffer, message );
+    message.append( text );
+
+    return message;
+}
+
+/** form log message from log record.
+ *
+ * @param record log record
+ *
+ * @return LogRecord#message if record already formatted<br>
+ *         message formed from prefix, formatted arguments and
+ *         hex data otherwise
+ */
+QString QtLogger::formatRecord( const LogRecord& record )
+{
+    if ( record.isFormatted() )
+    {
+        return record.message;
+    }
+
+    QString message;
+    formatPrefix( record, ProducerContext::current()->buffer, message );
+    message.append( record.formatArguments() );
 
-    return;
+    if ( !record.data.isEmpty() )
+    {
+        message.append( hexData( record.data.constData(), record.data.size() ) );
+    }
+
+    return message;
 }
 
 /** finish logging.
@@ -835,10 +2960,13 @@ void QtLogger::log(LOG_LEVEL level, QString module, QString message, const void*
  * set QtLogger#shutdown flag,
  * wake up QtLogger#run thread,
  * waits until it exits,
+ * deletes retired writers (see QtLogger#adoptWriters),
  * deletes objects in QtLogger#writersList
  * and cleans QtLogger#writersList list,
  * saves og levels for modules
- * and deletes items in QtLogger#moduleMap
+ * and resets records in QtLogger#moduleLevels.
+ *
+ * does nothing if already called.
  */
 void QtLogger::finishLogging()
 {
@@ -846,11 +2974,18 @@ void QtLogger::finishLogging()
     std::clog << FUNCTION_NAME << std::endl;
 #endif
 
+    stopControlServer();
+
     mqMutex.lock();
+    if ( shutdown )
+    {
+        mqMutex.unlock();
+        return;
+    }
 #if LQTL_ENABLE_LOGGER_LOGGING
     std::clog << FUNCTION_NAME
-            << " messageQueue size: "
-            << messageQueue.size()
+            << " messageRing empty: "
+            << ( messageRing.isEmpty()?"T":"f" )
             << std::endl;
 #endif
     shutdown = true;
@@ -858,6 +2993,11 @@ void QtLogger::finishLogging()
     mqWait.wakeAll();
     mqMutex.unlock();
 
+    // producers waiting for space drop their records
+    spaceMutex.lock();
+    spaceWait.wakeAll();
+    spaceMutex.unlock();
+
 #if LQTL_ENABLE_LOGGER_LOGGING
     std::clog << FUNCTION_NAME
             << " wait thread to end"
@@ -870,11 +3010,15 @@ void QtLogger::finishLogging()
             << " cleanup writers list"
             << std::endl;
 #endif
+    wlMutex.lock();
+    adoptWriters();
+    activeWriters.clear();
     while ( !writersList.isEmpty() )
     {
         delete( writersList.front() );
         writersList.pop_front();
     }
+    wlMutex.unlock();
 
 #if LQTL_ENABLE_LOGGER_LOGGING
     std::clog << FUNCTION_NAME
@@ -885,14 +3029,12 @@ void QtLogger::finishLogging()
 
 #if LQTL_ENABLE_LOGGER_LOGGING
     std::clog << FUNCTION_NAME
-            << " cleanup moduleMap"
+            << " cleanup moduleLevels"
             << std::endl;
 #endif
-    QMapIterator< QString, MODULE_LEVEL* > iter( moduleMap );
-    while ( iter.hasNext() )
-    {
-        delete( iter.next().value() );
-    }
+    mmMutex.lock();
+    moduleLevels.fill( noModuleLevel );
+    mmMutex.unlock();
 
 #if LQTL_ENABLE_LOGGER_LOGGING
     std::clog << FUNCTION_NAME
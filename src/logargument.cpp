@@ -0,0 +1,489 @@
+// Copyright (c) 2012, Ilya Arefiev <arefiev.id@gmail.com>
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the
+//    distribution.
+//  * Neither the name of the author nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+// IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+// TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+// PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include    <stdio.h>
+#include    <string.h>
+
+#include    "libqtlogger_common.h"
+#include    "logargument.h"
+
+using namespace ilardm::lib::qtlogger;
+
+/** append 8-bit string to format buffer.
+ *
+ * ASCII characters appended as is,
+ * the rest of string converted from UTF-8
+ * on first non-ASCII character.
+ *
+ * @param buffer    format buffer
+ * @param str       string to append
+ * @param length    string length
+ */
+static void appendUtf8( LogArgument::FORMAT_BUFFER& buffer, const char* str, int length )
+{
+    for ( int i = 0; i < length; i++ )
+    {
+        if ( (uchar)str[i] >= 0x80 )
+        {
+            QString rest = QString::fromUtf8( str + i, length - i );
+            buffer.append( rest.unicode(), rest.size() );
+            return;
+        }
+
+        buffer.append( QChar( str[i] ) );
+    }
+}
+
+/** blank argument constructor.
+ */
+LogArgument::LogArgument()
+    : type( AT_NONE ),
+      length( 0 )
+{
+    value.integer = 0;
+}
+
+/** boolean argument constructor.
+ */
+LogArgument::LogArgument( bool v )
+    : type( AT_BOOLEAN ),
+      length( 0 )
+{
+    value.integer = v;
+}
+
+/** character argument constructor.
+ */
+LogArgument::LogArgument( char v )
+    : type( AT_CHARACTER ),
+      length( 0 )
+{
+    value.integer = (uchar)v;
+}
+
+/** integer argument constructor.
+ */
+LogArgument::LogArgument( signed char v )
+    : type( AT_INTEGER ),
+      length( 0 )
+{
+    value.integer = v;
+}
+
+/** integer argument constructor.
+ */
+LogArgument::LogArgument( unsigned char v )
+    : type( AT_UNSIGNED ),
+      length( 0 )
+{
+    value.uinteger = v;
+}
+
+/** integer argument constructor.
+ */
+LogArgument::LogArgument( short v )
+    : type( AT_INTEGER ),
+      length( 0 )
+{
+    value.integer = v;
+}
+
+/** integer argument constructor.
+ */
+LogArgument::LogArgument( unsigned short v )
+    : type( AT_UNSIGNED ),
+      length( 0 )
+{
+    value.uinteger = v;
+}
+
+/** integer argument constructor.
+ */
+LogArgument::LogArgument( int v )
+    : type( AT_INTEGER ),
+      length( 0 )
+{
+    value.integer = v;
+}
+
+/** integer argument constructor.
+ */
+LogArgument::LogArgument( unsigned int v )
+    : type( AT_UNSIGNED ),
+      length( 0 )
+{
+    value.uinteger = v;
+}
+
+/** integer argument constructor.
+ */
+LogArgument::LogArgument( long v )
+    : type( AT_INTEGER ),
+      length( 0 )
+{
+    value.integer = v;
+}
+
+/** integer argument constructor.
+ */
+LogArgument::LogArgument( unsigned long v )
+    : type( AT_UNSIGNED ),
+      length( 0 )
+{
+    value.uinteger = v;
+}
+
+/** integer argument constructor.
+ */
+LogArgument::LogArgument( long long v )
+    : type( AT_INTEGER ),
+      length( 0 )
+{
+    value.integer = v;
+}
+
+/** integer argument constructor.
+ */
+LogArgument::LogArgument( unsigned long long v )
+    : type( AT_UNSIGNED ),
+      length( 0 )
+{
+    value.uinteger = v;
+}
+
+/** floating point argument constructor.
+ */
+LogArgument::LogArgument( float v )
+    : type( AT_DOUBLE ),
+      length( 0 )
+{
+    value.real = v;
+}
+
+/** floating point argument constructor.
+ */
+LogArgument::LogArgument( double v )
+    : type( AT_DOUBLE ),
+      length( 0 )
+{
+    value.real = v;
+}
+
+/** pointer argument constructor.
+ */
+LogArgument::LogArgument( const void* v )
+    : type( AT_POINTER ),
+      length( 0 )
+{
+    value.pointer = v;
+}
+
+/** C string argument constructor.
+ *
+ * NULL pointer formatted as "(null)"
+ */
+LogArgument::LogArgument( const char* v )
+    : type( AT_STRING ),
+      length( 0 )
+{
+    value.string = ( v ? v : "(null)" );
+    length = strlen( value.string );
+}
+
+/** 8-bit string argument constructor.
+ *
+ * @param v         string data
+ * @param size      string length
+ */
+LogArgument::LogArgument( const char* v, int size )
+    : type( AT_STRING ),
+      length( size )
+{
+    value.string = v;
+}
+
+/** QByteArray argument constructor.
+ *
+ * references array data, no copy made
+ */
+LogArgument::LogArgument( const QByteArray& v )
+    : type( AT_STRING ),
+      length( v.size() )
+{
+    value.string = v.constData();
+}
+
+/** QString argument constructor.
+ *
+ * references string data, no conversion made
+ */
+LogArgument::LogArgument( const QString& v )
+    : type( AT_UTF16 ),
+      length( v.size() )
+{
+    value.utf16 = v.unicode();
+}
+
+/** UTF-16 string argument constructor.
+ *
+ * @param v         string data, may be unaligned
+ * @param size      string length in characters
+ */
+LogArgument::LogArgument( const QChar* v, int size )
+    : type( AT_UTF16 ),
+      length( size )
+{
+    value.utf16 = v;
+}
+
+/** append argument value to format buffer.
+ *
+ * @param buffer format buffer
+ */
+void LogArgument::appendTo( FORMAT_BUFFER& buffer ) const
+{
+    char tmp[64];
+    int tmplen = 0;
+
+    switch ( type )
+    {
+    case AT_INTEGER:
+        tmplen = snprintf( tmp, sizeof( tmp ), "%lld", (long long)value.integer );
+        break;
+    case AT_UNSIGNED:
+        tmplen = snprintf( tmp, sizeof( tmp ), "%llu", (unsigned long long)value.uinteger );
+        break;
+    case AT_CHARACTER:
+        buffer.append( QChar( (int)value.integer ) );
+        return;
+    case AT_BOOLEAN:
+        tmplen = snprintf( tmp, sizeof( tmp ), "%s", ( value.integer ? "true" : "false" ) );
+        break;
+    case AT_DOUBLE:
+        tmplen = snprintf( tmp, sizeof( tmp ), "%g", value.real );
+        break;
+    case AT_POINTER:
+        tmplen = snprintf( tmp, sizeof( tmp ), "%p", value.pointer );
+        break;
+    case AT_STRING:
+        appendUtf8( buffer, value.string, length );
+        return;
+    case AT_UTF16:
+    {
+        // data may be unaligned when deserialized
+        int offset = buffer.size();
+        buffer.resize( offset + length );
+        memcpy( buffer.data() + offset, value.utf16, length * sizeof( QChar ) );
+        return;
+    }
+    default:
+        return;
+    }
+
+    if ( tmplen > (int)sizeof( tmp ) - 1 )
+    {
+        tmplen = sizeof( tmp ) - 1;
+    }
+    appendUtf8( buffer, tmp, ( tmplen > 0 ? tmplen : 0 ) );
+}
+
+/** format message with '{}' placeholders.
+ *
+ * message formatted into stack buffer, so the only
+ * heap allocation is the resulting string.
+ * placeholders without argument are kept as is,
+ * arguments without placeholder are appended to the
+ * end of message separated by space.
+ *
+ * @param fmt       message format
+ * @param args      arguments array
+ * @param count     number of arguments
+ *
+ * @return formatted message
+ */
+QString LogArgument::format( const char* fmt, const LogArgument* args, int count )
+{
+    FORMAT_BUFFER buffer;
+    int next = 0;
+
+    const char* p = fmt;
+    const char* text = p;
+    while ( p && *p )
+    {
+        if ( ( p[0] == '{' && p[1] == '{' )
+             || ( p[0] == '}' && p[1] == '}' )
+        ) {
+            appendUtf8( buffer, text, (int)( p - text ) + 1 );
+            p += 2;
+            text = p;
+        }
+        else if ( p[0] == '{'
+                  && p[1] == '}'
+        ) {
+            appendUtf8( buffer, text, (int)( p - text ) );
+            if ( next < count )
+            {
+                args[ next++ ].appendTo( buffer );
+            }
+            else
+            {
+                appendUtf8( buffer, p, 2 );
+            }
+            p += 2;
+            text = p;
+        }
+        else
+        {
+            p++;
+        }
+    }
+    appendUtf8( buffer, text, (int)( p - text ) );
+
+    while ( next < count )
+    {
+        buffer.append( QChar(' ') );
+        args[ next++ ].appendTo( buffer );
+    }
+
+    return QString( buffer.constData(), buffer.size() );
+}
+
+/** append serialized argument to capture buffer.
+ *
+ * strings are copied, so serialized argument does not
+ * depend on lifetime of value it was constructed from.
+ *
+ * @param out capture buffer to append to (see LogRecord#captureArguments)
+ */
+void LogArgument::serialize( LogRecord::CAPTURE_BUFFER& out ) const
+{
+    out.append( (char)type );
+
+    switch ( type )
+    {
+    case AT_STRING:
+    {
+        quint32 size = length;
+        out.append( (const char*)&size, sizeof( size ) );
+        out.append( value.string, length );
+        break;
+    }
+    case AT_UTF16:
+    {
+        quint32 size = length;
+        out.append( (const char*)&size, sizeof( size ) );
+        out.append( (const char*)value.utf16, length * sizeof( QChar ) );
+        break;
+    }
+    case AT_POINTER:
+        out.append( (const char*)&value.pointer, sizeof( value.pointer ) );
+        break;
+    case AT_NONE:
+        break;
+    default:
+        out.append( (const char*)&value.integer, sizeof( value.integer ) );
+        break;
+    }
+}
+
+/** restore argument serialized by LogArgument#serialize.
+ *
+ * strings reference serialized data, so it must
+ * outlive restored argument.
+ *
+ * @param p     serialized data
+ * @param end   end of serialized data
+ * @param arg   argument to restore
+ *
+ * @return pointer next to restored argument<br>
+ *         NULL if data is broken
+ */
+const char* LogArgument::deserialize( const char* p, const char* end, LogArgument* arg )
+{
+    if ( p >= end )
+    {
+        return NULL;
+    }
+
+    arg->type = (ARGUMENT_TYPE)*p++;
+    arg->length = 0;
+
+    switch ( arg->type )
+    {
+    case AT_STRING:
+    case AT_UTF16:
+    {
+        quint32 size;
+        if ( p + sizeof( size ) > end )
+        {
+            return NULL;
+        }
+        memcpy( &size, p, sizeof( size ) );
+        p += sizeof( size );
+
+        size_t bytes = size * ( arg->type == AT_UTF16 ? sizeof( QChar ) : 1 );
+        if ( p + bytes > end )
+        {
+            return NULL;
+        }
+
+        arg->length = size;
+        if ( arg->type == AT_UTF16 )
+        {
+            arg->value.utf16 = (const QChar*)p;
+        }
+        else
+        {
+            arg->value.string = p;
+        }
+        return p + bytes;
+    }
+    case AT_POINTER:
+        if ( p + sizeof( arg->value.pointer ) > end )
+        {
+            return NULL;
+        }
+        memcpy( &arg->value.pointer, p, sizeof( arg->value.pointer ) );
+        return p + sizeof( arg->value.pointer );
+    case AT_INTEGER:
+    case AT_UNSIGNED:
+    case AT_CHARACTER:
+    case AT_BOOLEAN:
+    case AT_DOUBLE:
+        if ( p + sizeof( arg->value.integer ) > end )
+        {
+            return NULL;
+        }
+        memcpy( &arg->value.integer, p, sizeof( arg->value.integer ) );
+        return p + sizeof( arg->value.integer );
+    case AT_NONE:
+        return p;
+    default:
+        return NULL;
+    }
+}
@@ -0,0 +1,1191 @@
+// Copyright (c) 2012, Ilya Arefiev <arefiev.id@gmail.com>
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the
+//    distribution.
+//  * Neither the name of the author nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+// IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+// TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+// PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include    <string.h>
+#include    <stddef.h>
+#include    <stdint.h>
+#include    <errno.h>
+
+#include    "libqtlogger_common.h"
+#include    "logrecord.h"
+#include    "logargument.h"
+
+// platform headers depend on Q_OS_* defines
+#if defined ( Q_OS_UNIX )
+#include    <unistd.h>
+#elif defined ( Q_OS_WIN32 )
+#include    <io.h>
+#endif
+
+using namespace ilardm::lib::qtlogger;
+
+/** parsed printf-like conversion specification.
+ *
+ * all pointers point into format string:<br>
+ * %[flags][width][.precision][length]conversion
+ */
+typedef struct {
+    const char* begin;          /**< '%' character */
+    const char* flagsEnd;       /**< end of flags, start of width */
+    const char* widthEnd;       /**< end of width, start of precision */
+    const char* precisionEnd;   /**< end of precision, start of length modifier */
+    const char* end;            /**< character next to conversion */
+    bool widthArgument;         /**< width passed as '*' argument */
+    bool precisionArgument;     /**< precision passed as '*' argument */
+    int precision;              /**< explicit precision, -1 if not set */
+    int length;                 /**< #LENGTH_MODIFIER */
+    char conversion;            /**< conversion character */
+} FORMAT_SPEC;
+
+/** fixed part of record serialized by LogRecord#serialize.
+ *
+ * followed by LogRecord#message characters,
+ * LogRecord#threadTag, LogRecord#arguments and
+ * LogRecord#data bytes.
+ */
+typedef struct {
+    qint64      timestamp;      /**< LogRecord#timestamp */
+    const char* file;           /**< LogRecord#file */
+    const char* function;       /**< LogRecord#function */
+    const char* format;         /**< LogRecord#format */
+    void*       threadId;       /**< LogRecord#threadId */
+    qint32      level;          /**< LogRecord#level */
+    qint32      line;           /**< LogRecord#line */
+    quint32     sequence;       /**< LogRecord#sequence */
+    qint32      braceFormat;    /**< LogRecord#braceFormat */
+    qint32      messageSize;    /**< number of message characters, -1 for null message */
+    qint32      threadTagSize;  /**< number of thread tag bytes */
+    qint32      argumentsSize;  /**< number of captured arguments bytes */
+    qint32      dataSize;       /**< number of dumped data bytes */
+} SERIALIZED_RECORD;
+
+/** printf length modifiers.
+ */
+typedef enum {
+    LM_NONE,
+    LM_CHAR,            /**< hh */
+    LM_SHORT,           /**< h */
+    LM_LONG,            /**< l */
+    LM_LONG_LONG,       /**< ll, q */
+    LM_INTMAX,          /**< j */
+    LM_SIZE,            /**< z */
+    LM_PTRDIFF,         /**< t */
+    LM_LONG_DOUBLE      /**< L */
+} LENGTH_MODIFIER;
+
+/** parse conversion specification.
+ *
+ * @param p     pointer to '%' character in format string
+ * @param spec  structure to fill
+ *
+ * @return pointer to the character next to conversion
+ */
+static const char* parseFormatSpec( const char* p, FORMAT_SPEC* spec )
+{
+    spec->begin = p++;
+
+    while ( *p && strchr( "-+ #0'", *p ) )
+    {
+        p++;
+    }
+    spec->flagsEnd = p;
+
+    spec->widthArgument = false;
+    if ( *p == '*' )
+    {
+        spec->widthArgument = true;
+        p++;
+    }
+    else
+    {
+        while ( *p >= '0' && *p <= '9' )
+        {
+            p++;
+        }
+    }
+    spec->widthEnd = p;
+
+    spec->precisionArgument = false;
+    spec->precision = -1;
+    if ( *p == '.' )
+    {
+        p++;
+        if ( *p == '*' )
+        {
+            spec->precisionArgument = true;
+            p++;
+        }
+        else
+        {
+            spec->precision = 0;
+            while ( *p >= '0' && *p <= '9' )
+            {
+                spec->precision = spec->precision * 10 + ( *p - '0' );
+                p++;
+            }
+        }
+    }
+    spec->precisionEnd = p;
+
+    spec->length = LM_NONE;
+    switch ( *p )
+    {
+    case 'h':
+        spec->length = ( *(p+1) == 'h' ) ? LM_CHAR : LM_SHORT;
+        p += ( spec->length == LM_CHAR ) ? 2 : 1;
+        break;
+    case 'l':
+        spec->length = ( *(p+1) == 'l' ) ? LM_LONG_LONG : LM_LONG;
+        p += ( spec->length == LM_LONG_LONG ) ? 2 : 1;
+        break;
+    case 'q':
+        spec->length = LM_LONG_LONG;
+        p++;
+        break;
+    case 'j':
+        spec->length = LM_INTMAX;
+        p++;
+        break;
+    case 'z':
+        spec->length = LM_SIZE;
+        p++;
+        break;
+    case 't':
+        spec->length = LM_PTRDIFF;
+        p++;
+        break;
+    case 'L':
+        spec->length = LM_LONG_DOUBLE;
+        p++;
+        break;
+    default:
+        break;
+    }
+
+    spec->conversion = *p;
+    if ( *p )
+    {
+        p++;
+    }
+    spec->end = p;
+
+    return p;
+}
+
+/** capture UTF-16 string as LogRecord#AT_WIDE_STRING.
+ *
+ * QString::vsprintf takes %ls as zero terminated UTF-16 string
+ * (i.e. QString#utf16), so units are copied as they are.
+ *
+ * @param out       capture buffer
+ * @param value     UTF-16 string, may be NULL
+ * @param precision maximum number of units, -1 for no limit
+ */
+static void captureWideString( LogRecord::CAPTURE_BUFFER& out, const ushort* value, int precision )
+{
+    quint32 length = 0;
+    while ( value
+            && value[length]
+            && ( precision < 0 || length < (quint32)precision )
+    ) {
+        length++;
+    }
+
+    out.append( (char)LogRecord::AT_WIDE_STRING );
+    out.append( (const char*)&length, sizeof( length ) );
+    out.append( (const char*)value, length * sizeof( ushort ) );
+}
+
+/** format captured LogRecord#AT_WIDE_STRING argument.
+ *
+ * @param result        message to append formatted argument to
+ * @param conversion    conversion specification without conversion character
+ * @param args          captured arguments, advanced past formatted one
+ * @param argsEnd       end of captured arguments
+ *
+ * @return true if argument formatted<br>
+ *         false if arguments are broken
+ */
+static bool formatWideString( QString& result, QByteArray conversion, const char*& args, const char* argsEnd )
+{
+    quint32 length = 0;
+    if ( args >= argsEnd
+         || *args != LogRecord::AT_WIDE_STRING
+         || args + 1 + sizeof( length ) > argsEnd
+    ) {
+        return false;
+    }
+    memcpy( &length, args + 1, sizeof( length ) );
+    if ( args + 1 + sizeof( length ) + length * sizeof( QChar ) > argsEnd )
+    {
+        return false;
+    }
+
+    // characters may be unaligned in captured data
+    QString value( (int)length, QChar() );
+    memcpy( value.data(), args + 1 + sizeof( length ), length * sizeof( QChar ) );
+    args += 1 + sizeof( length ) + length * sizeof( QChar );
+
+    conversion.append( "ls" );
+    result.append( QString().sprintf( conversion.constData(), value.utf16() ) );
+
+    return true;
+}
+
+/** dummy constructor.
+ *
+ * initializes record as blank one.
+ */
+LogRecord::LogRecord()
+    : level( 0 ),
+      timestamp( 0 ),
+      sequence( 0 ),
+      file( NULL ),
+      line( 0 ),
+      function( NULL ),
+      threadId( NULL ),
+      format( NULL ),
+      braceFormat( false ),
+      capturedArguments( NULL ),
+      capturedArgumentsSize( 0 ),
+      referencedData( NULL ),
+      referencedDataSize( 0 )
+{
+}
+
+/** check whether record already holds formatted message.
+ *
+ * @return true if LogRecord#message is set<br>
+ *         false if message should be formatted by LogRecord#formatArguments
+ */
+bool LogRecord::isFormatted() const
+{
+    return !message.isNull();
+}
+
+/** copy format arguments into capture buffer.
+ *
+ * walks passed printf-like format and copies each argument
+ * value tagged with LogRecord#ARGUMENT_TYPE. strings are copied
+ * (respecting precision), so they may be freed right after call.
+ * UTF-16 strings and characters (%ls, %lc) are copied the same
+ * way QString::vsprintf takes them: as ushort units.
+ * integers are widened to qint64 after applying length modifier,
+ * so formatting gives the same result as at call site.
+ *
+ * buffer lives on caller's stack, so nothing is allocated unless
+ * arguments do not fit into it. record references buffer
+ * (LogRecord#capturedArguments) until it is serialized.
+ *
+ * @param fmt   message format
+ * @param ap    format arguments
+ * @param out   capture buffer, must outlive LogRecord#serialize call
+ */
+void LogRecord::captureArguments( const char* fmt, va_list ap, CAPTURE_BUFFER& out )
+{
+    format = fmt;
+    braceFormat = false;
+    arguments.clear();
+    out.clear();
+
+    const char* p = fmt;
+    while ( p && *p )
+    {
+        if ( *p != '%' )
+        {
+            p++;
+            continue;
+        }
+        if ( *(p+1) == '%' )
+        {
+            p += 2;
+            continue;
+        }
+
+        FORMAT_SPEC spec;
+        p = parseFormatSpec( p, &spec );
+
+        qint64 integer = 0;
+        int precision = spec.precision;
+
+        if ( spec.widthArgument )
+        {
+            integer = va_arg( ap, int );
+            out.append( (char)AT_INTEGER );
+            out.append( (const char*)&integer, sizeof( integer ) );
+        }
+        if ( spec.precisionArgument )
+        {
+            precision = va_arg( ap, int );
+            integer = precision;
+            out.append( (char)AT_INTEGER );
+            out.append( (const char*)&integer, sizeof( integer ) );
+        }
+
+        switch ( spec.conversion )
+        {
+        case 'd':
+        case 'i':
+            switch ( spec.length )
+            {
+            case LM_CHAR:       integer = (signed char)va_arg( ap, int );   break;
+            case LM_SHORT:      integer = (short)va_arg( ap, int );         break;
+            case LM_LONG:       integer = va_arg( ap, long );               break;
+            case LM_LONG_LONG:  integer = va_arg( ap, long long );          break;
+            case LM_INTMAX:     integer = va_arg( ap, intmax_t );           break;
+            case LM_SIZE:       integer = (ptrdiff_t)va_arg( ap, size_t );  break;
+            case LM_PTRDIFF:    integer = va_arg( ap, ptrdiff_t );          break;
+            default:            integer = va_arg( ap, int );                break;
+            }
+            out.append( (char)AT_INTEGER );
+            out.append( (const char*)&integer, sizeof( integer ) );
+            break;
+
+        case 'u':
+        case 'o':
+        case 'x':
+        case 'X':
+            switch ( spec.length )
+            {
+            case LM_CHAR:       integer = (unsigned char)va_arg( ap, unsigned int );    break;
+            case LM_SHORT:      integer = (unsigned short)va_arg( ap, unsigned int );   break;
+            case LM_LONG:       integer = va_arg( ap, unsigned long );                  break;
+            case LM_LONG_LONG:  integer = va_arg( ap, unsigned long long );             break;
+            case LM_INTMAX:     integer = va_arg( ap, uintmax_t );                      break;
+            case LM_SIZE:       integer = va_arg( ap, size_t );                         break;
+            case LM_PTRDIFF:    integer = va_arg( ap, ptrdiff_t );                      break;
+            default:            integer = va_arg( ap, unsigned int );                   break;
+            }
+            out.append( (char)AT_INTEGER );
+            out.append( (const char*)&integer, sizeof( integer ) );
+            break;
+
+        case 'c':
+            if ( spec.length == LM_LONG )
+            {
+                // ushort is promoted to int
+                ushort value = (ushort)va_arg( ap, int );
+                quint32 length = 1;
+                out.append( (char)AT_WIDE_STRING );
+                out.append( (const char*)&length, sizeof( length ) );
+                out.append( (const char*)&value, sizeof( value ) );
+                break;
+            }
+            integer = va_arg( ap, int );
+            out.append( (char)AT_CHARACTER );
+            out.append( (const char*)&integer, sizeof( integer ) );
+            break;
+
+        case 'e':
+        case 'E':
+        case 'f':
+        case 'F':
+        case 'g':
+        case 'G':
+        case 'a':
+        case 'A':
+            if ( spec.length == LM_LONG_DOUBLE )
+            {
+                long double value = va_arg( ap, long double );
+                out.append( (char)AT_LONG_DOUBLE );
+                out.append( (const char*)&value, sizeof( value ) );
+            }
+            else
+            {
+                double value = va_arg( ap, double );
+                out.append( (char)AT_DOUBLE );
+                out.append( (const char*)&value, sizeof( value ) );
+            }
+            break;
+
+        case 's':
+        {
+            if ( spec.length == LM_LONG )
+            {
+                captureWideString( out, va_arg( ap, const ushort* ), precision );
+                break;
+            }
+
+            const char* value = va_arg( ap, const char* );
+            if ( !value )
+            {
+                value = "(null)";
+            }
+
+            quint32 length = 0;
+            while ( value[length]
+                    && ( precision < 0 || length < (quint32)precision )
+            ) {
+                length++;
+            }
+
+            out.append( (char)AT_STRING );
+            out.append( (const char*)&length, sizeof( length ) );
+            out.append( value, length );
+            break;
+        }
+
+        case 'p':
+        {
+            void* value = va_arg( ap, void* );
+            out.append( (char)AT_POINTER );
+            out.append( (const char*)&value, sizeof( value ) );
+            break;
+        }
+
+        case 'n':
+            // never written back
+            (void)va_arg( ap, void* );
+            break;
+
+        default:
+            // unknown conversion consumes no argument
+            break;
+        }
+    }
+
+    capturedArguments = out.constData();
+    capturedArgumentsSize = out.size();
+}
+
+/** copy '{}'-style format arguments into capture buffer.
+ *
+ * overloaded function.
+ * serializes passed arguments (see LogArgument#serialize),
+ * so referenced strings may be freed right after call.
+ *
+ * @param fmt   message format
+ * @param args  arguments array
+ * @param count number of arguments
+ * @param out   capture buffer, must outlive LogRecord#serialize call
+ */
+void LogRecord::captureArguments( const char* fmt, const LogArgument* args, int count, CAPTURE_BUFFER& out )
+{
+    format = fmt;
+    braceFormat = true;
+    arguments.clear();
+    out.clear();
+
+    for ( int i = 0; i < count; i++ )
+    {
+        args[i].serialize( out );
+    }
+
+    capturedArguments = out.constData();
+    capturedArgumentsSize = out.size();
+}
+
+/** reference data to dump in hex instead of copying it.
+ *
+ * data is copied straight into ring by LogRecord#serialize,
+ * so it must not be freed until record is enqueued.
+ *
+ * @param data      data to dump
+ * @param datasz    size of data to dump
+ */
+void LogRecord::referenceData( const void* data, size_t datasz )
+{
+    referencedData = (const char*)data;
+    referencedDataSize = ( data ? (int)datasz : 0 );
+}
+
+/** format message from LogRecord#format and LogRecord#arguments.
+ *
+ * each conversion specification formatted separately with
+ * its captured value. integer length modifiers replaced by 'll'
+ * since values were widened by LogRecord#captureArguments.
+ * '{}'-style formats formatted by LogArgument#format.
+ *
+ * @return formatted message<br>
+ *         or LogRecord#message if record is already formatted
+ */
+QString LogRecord::formatArguments() const
+{
+    if ( isFormatted() )
+    {
+        return message;
+    }
+
+    QString result;
+    if ( !format )
+    {
+        return result;
+    }
+
+    if ( braceFormat )
+    {
+        QVarLengthArray< LogArgument, 16 > args;
+        const char* p = arguments.constData();
+        const char* end = p + arguments.size();
+        while ( p && p < end )
+        {
+            LogArgument arg;
+            p = LogArgument::deserialize( p, end, &arg );
+            if ( p )
+            {
+                args.append( arg );
+            }
+        }
+
+        return LogArgument::format( format, args.constData(), args.size() );
+    }
+
+    const char* args = arguments.constData();
+    const char* argsEnd = args + arguments.size();
+
+    const char* p = format;
+    const char* text = p;
+    while ( *p )
+    {
+        if ( *p != '%' )
+        {
+            p++;
+            continue;
+        }
+
+        result.append( QString::fromUtf8( text, (int)( p - text ) ) );
+
+        if ( *(p+1) == '%' )
+        {
+            result.append( QChar('%') );
+            p += 2;
+            text = p;
+            continue;
+        }
+
+        FORMAT_SPEC spec;
+        p = parseFormatSpec( p, &spec );
+        text = p;
+
+        // rebuild conversion specification
+        QByteArray conversion( spec.begin, (int)( spec.flagsEnd - spec.begin ) );
+        qint64 integer = 0;
+        bool broken = false;
+
+        if ( spec.widthArgument )
+        {
+            if ( args + 1 + sizeof( integer ) <= argsEnd
+                 && *args == AT_INTEGER
+            ) {
+                memcpy( &integer, args + 1, sizeof( integer ) );
+                args += 1 + sizeof( integer );
+                conversion.append( QByteArray::number( (int)integer ) );
+            }
+            else
+            {
+                broken = true;
+            }
+        }
+        else
+        {
+            conversion.append( spec.flagsEnd, (int)( spec.widthEnd - spec.flagsEnd ) );
+        }
+
+        if ( spec.precisionArgument )
+        {
+            if ( args + 1 + sizeof( integer ) <= argsEnd
+                 && *args == AT_INTEGER
+            ) {
+                memcpy( &integer, args + 1, sizeof( integer ) );
+                args += 1 + sizeof( integer );
+                if ( integer >= 0 )
+                {
+                    conversion.append( '.' );
+                    conversion.append( QByteArray::number( (int)integer ) );
+                }
+            }
+            else
+            {
+                broken = true;
+            }
+        }
+        else
+        {
+            conversion.append( spec.widthEnd, (int)( spec.precisionEnd - spec.widthEnd ) );
+        }
+
+        char type = ( !broken && args < argsEnd ) ? *args : 0;
+        switch ( spec.conversion )
+        {
+        case 'd':
+        case 'i':
+        case 'u':
+        case 'o':
+        case 'x':
+        case 'X':
+            if ( type == AT_INTEGER
+                 && args + 1 + sizeof( integer ) <= argsEnd
+            ) {
+                memcpy( &integer, args + 1, sizeof( integer ) );
+                args += 1 + sizeof( integer );
+
+                conversion.append( "ll" );
+                conversion.append( spec.conversion );
+                result.append( QString().sprintf( conversion.constData(), (long long)integer ) );
+            }
+            else
+            {
+                broken = true;
+            }
+            break;
+
+        case 'c':
+            if ( type == AT_WIDE_STRING )
+            {
+                broken = !formatWideString( result, conversion, args, argsEnd );
+            }
+            else if ( type == AT_CHARACTER
+                      && args + 1 + sizeof( integer ) <= argsEnd
+            ) {
+                memcpy( &integer, args + 1, sizeof( integer ) );
+                args += 1 + sizeof( integer );
+
+                conversion.append( 'c' );
+                result.append( QString().sprintf( conversion.constData(), (int)integer ) );
+            }
+            else
+            {
+                broken = true;
+            }
+            break;
+
+        case 'e':
+        case 'E':
+        case 'f':
+        case 'F':
+        case 'g':
+        case 'G':
+        case 'a':
+        case 'A':
+            if ( type == AT_DOUBLE
+                 && args + 1 + sizeof( double ) <= argsEnd
+            ) {
+                double value;
+                memcpy( &value, args + 1, sizeof( value ) );
+                args += 1 + sizeof( value );
+
+                conversion.append( spec.conversion );
+                result.append( QString().sprintf( conversion.constData(), value ) );
+            }
+            else if ( type == AT_LONG_DOUBLE
+                      && args + 1 + sizeof( long double ) <= argsEnd
+            ) {
+                long double value;
+                memcpy( &value, args + 1, sizeof( value ) );
+                args += 1 + sizeof( value );
+
+                conversion.append( 'L' );
+                conversion.append( spec.conversion );
+                result.append( QString().sprintf( conversion.constData(), value ) );
+            }
+            else
+            {
+                broken = true;
+            }
+            break;
+
+        case 's':
+        {
+            if ( type == AT_WIDE_STRING )
+            {
+                broken = !formatWideString( result, conversion, args, argsEnd );
+                break;
+            }
+
+            quint32 length = 0;
+            if ( type == AT_STRING
+                 && args + 1 + sizeof( length ) <= argsEnd
+            ) {
+                memcpy( &length, args + 1, sizeof( length ) );
+            }
+            if ( type == AT_STRING
+                 && args + 1 + sizeof( length ) + length <= argsEnd
+            ) {
+                QByteArray value( args + 1 + sizeof( length ), length );
+                args += 1 + sizeof( length ) + length;
+
+                conversion.append( 's' );
+                result.append( QString().sprintf( conversion.constData(), value.constData() ) );
+            }
+            else
+            {
+                broken = true;
+            }
+            break;
+        }
+
+        case 'p':
+            if ( type == AT_POINTER
+                 && args + 1 + sizeof( void* ) <= argsEnd
+            ) {
+                void* value;
+                memcpy( &value, args + 1, sizeof( value ) );
+                args += 1 + sizeof( value );
+
+                conversion.append( 'p' );
+                result.append( QString().sprintf( conversion.constData(), value ) );
+            }
+            else
+            {
+                broken = true;
+            }
+            break;
+
+        case 'n':
+            break;
+
+        default:
+            // unknown conversion: keep as is
+            result.append( QString::fromUtf8( spec.begin, (int)( spec.end - spec.begin ) ) );
+            break;
+        }
+
+        if ( broken )
+        {
+            // arguments do not match format: stop formatting, keep the rest as is
+            result.append( QString::fromUtf8( spec.begin ) );
+            return result;
+        }
+    }
+
+    result.append( QString::fromUtf8( text, (int)( p - text ) ) );
+
+    return result;
+}
+
+/** get size of record serialized by LogRecord#serialize.
+ *
+ * @return number of bytes
+ */
+int LogRecord::serializedSize() const
+{
+    return sizeof( SERIALIZED_RECORD )
+           + message.size() * sizeof( QChar )
+           + threadTag.size()
+           + ( capturedArguments ? capturedArgumentsSize : arguments.size() )
+           + ( referencedData ? referencedDataSize : data.size() );
+}
+
+/** serialize record into plain memory.
+ *
+ * strings referenced by pointer (format, file, function)
+ * are not copied: they are string literals.
+ * captured arguments and referenced data (see
+ * LogRecord#captureArguments) are copied from caller's memory.
+ *
+ * @param out buffer of at least LogRecord#serializedSize bytes
+ */
+void LogRecord::serialize( char* out ) const
+{
+    SERIALIZED_RECORD header;
+    header.timestamp = timestamp;
+    header.file = file;
+    header.function = function;
+    header.format = format;
+    header.threadId = threadId;
+    header.level = level;
+    header.line = line;
+    header.sequence = sequence;
+    header.braceFormat = braceFormat;
+    header.messageSize = ( message.isNull() ? -1 : message.size() );
+    header.threadTagSize = threadTag.size();
+    header.argumentsSize = ( capturedArguments ? capturedArgumentsSize : arguments.size() );
+    header.dataSize = ( referencedData ? referencedDataSize : data.size() );
+
+    memcpy( out, &header, sizeof( header ) );
+    out += sizeof( header );
+
+    if ( header.messageSize > 0 )
+    {
+        memcpy( out, message.constData(), header.messageSize * sizeof( QChar ) );
+        out += header.messageSize * sizeof( QChar );
+    }
+    memcpy( out, threadTag.constData(), header.threadTagSize );
+    out += header.threadTagSize;
+    memcpy( out, ( capturedArguments ? capturedArguments : arguments.constData() ), header.argumentsSize );
+    out += header.argumentsSize;
+    memcpy( out, ( referencedData ? referencedData : data.constData() ), header.dataSize );
+}
+
+/** restore record serialized by LogRecord#serialize.
+ *
+ * @param in    serialized record
+ * @param size  number of serialized bytes
+ *
+ * @return true if record restored<br>
+ *         false if serialized data is broken
+ */
+bool LogRecord::deserialize( const char* in, int size )
+{
+    SERIALIZED_RECORD header;
+    if ( size < (int)sizeof( header ) )
+    {
+        return false;
+    }
+    memcpy( &header, in, sizeof( header ) );
+    in += sizeof( header );
+
+    int messageBytes = ( header.messageSize > 0 ? header.messageSize * (int)sizeof( QChar ) : 0 );
+    if ( header.threadTagSize < 0
+         || header.argumentsSize < 0
+         || header.dataSize < 0
+         || (int)sizeof( header ) + messageBytes
+            + header.threadTagSize + header.argumentsSize + header.dataSize > size
+    ) {
+        return false;
+    }
+
+    timestamp = header.timestamp;
+    file = header.file;
+    function = header.function;
+    format = header.format;
+    threadId = header.threadId;
+    level = header.level;
+    line = header.line;
+    sequence = header.sequence;
+    braceFormat = ( header.braceFormat != 0 );
+
+    if ( header.messageSize < 0 )
+    {
+        message = QString();
+    }
+    else
+    {
+        // characters may be unaligned in serialized data
+        message.resize( header.messageSize );
+        memcpy( message.data(), in, messageBytes );
+        in += messageBytes;
+    }
+    threadTag = QByteArray( in, header.threadTagSize );
+    in += header.threadTagSize;
+    arguments = QByteArray( in, header.argumentsSize );
+    in += header.argumentsSize;
+    data = QByteArray( in, header.dataSize );
+    capturedArguments = NULL;
+    capturedArgumentsSize = 0;
+    referencedData = NULL;
+    referencedDataSize = 0;
+
+    return true;
+}
+
+/** write bytes to file descriptor, async-signal-safe.
+ *
+ * @param fd    file descriptor
+ * @param p     bytes to write
+ * @param size  number of bytes
+ */
+static void safeWrite( int fd, const char* p, int size )
+{
+    while ( size > 0 )
+    {
+        int written = (int)::write( fd, p, size );
+        if ( written < 0 )
+        {
+            if ( errno == EINTR )
+            {
+                continue;
+            }
+            return;
+        }
+        p += written;
+        size -= written;
+    }
+}
+
+/** write zero-terminated string, async-signal-safe.
+ *
+ * @param fd    file descriptor
+ * @param s     string, may be NULL
+ */
+static void safeWriteString( int fd, const char* s )
+{
+    if ( s )
+    {
+        safeWrite( fd, s, (int)strlen( s ) );
+    }
+}
+
+/** write number, async-signal-safe.
+ *
+ * @param fd        file descriptor
+ * @param value     number absolute value
+ * @param negative  prepend with '-'
+ * @param base      10 or 16
+ * @param digits    minimal number of digits
+ */
+static void safeWriteNumber( int fd, quint64 value, bool negative, int base, int digits )
+{
+    char text[ 32 ];
+    int position = sizeof( text );
+
+    do
+    {
+        text[ --position ] = "0123456789abcdef"[ value % base ];
+        value /= base;
+        digits--;
+    } while ( ( value || digits > 0 )
+              && position > 1 );
+
+    if ( negative )
+    {
+        text[ --position ] = '-';
+    }
+
+    safeWrite( fd, text + position, sizeof( text ) - position );
+}
+
+/** write signed integer, async-signal-safe.
+ *
+ * @param fd    file descriptor
+ * @param value number
+ */
+static void safeWriteInteger( int fd, qint64 value )
+{
+    safeWriteNumber( fd,
+                     ( value < 0 ? (quint64)0 - (quint64)value : (quint64)value ),
+                     ( value < 0 ),
+                     10, 1 );
+}
+
+/** write UTF-16 characters as UTF-8, async-signal-safe.
+ *
+ * surrogate pairs are written as two 3-byte sequences.
+ *
+ * @param fd    file descriptor
+ * @param p     characters, may be unaligned
+ * @param count number of characters
+ */
+static void safeWriteUtf16( int fd, const char* p, int count )
+{
+    char chunk[ 256 ];
+    int length = 0;
+
+    for ( int i = 0; i < count; i++ )
+    {
+        quint16 c;
+        memcpy( &c, p + i * sizeof( c ), sizeof( c ) );
+
+        if ( length > (int)sizeof( chunk ) - 3 )
+        {
+            safeWrite( fd, chunk, length );
+            length = 0;
+        }
+
+        if ( c < 0x80 )
+        {
+            chunk[ length++ ] = (char)c;
+        }
+        else if ( c < 0x800 )
+        {
+            chunk[ length++ ] = (char)( 0xc0 | ( c >> 6 ) );
+            chunk[ length++ ] = (char)( 0x80 | ( c & 0x3f ) );
+        }
+        else
+        {
+            chunk[ length++ ] = (char)( 0xe0 | ( c >> 12 ) );
+            chunk[ length++ ] = (char)( 0x80 | ( ( c >> 6 ) & 0x3f ) );
+            chunk[ length++ ] = (char)( 0x80 | ( c & 0x3f ) );
+        }
+    }
+
+    safeWrite( fd, chunk, length );
+}
+
+/** write captured arguments, async-signal-safe.
+ *
+ * integers, characters, pointers and strings are written
+ * as is, floating point values as type name only.
+ *
+ * @param fd        file descriptor
+ * @param p         captured arguments (see LogRecord#arguments)
+ * @param end       end of captured arguments
+ * @param brace     arguments captured from '{}'-style format
+ *                  (see LogArgument#serialize)
+ */
+static void safeWriteArguments( int fd, const char* p, const char* end, bool brace )
+{
+    while ( p < end )
+    {
+        char tag = *p++;
+        safeWrite( fd, " ", 1 );
+
+        if ( tag == 's'
+             || tag == 'w'
+        ) {
+            quint32 length;
+            if ( p + sizeof( length ) > end )
+            {
+                return;
+            }
+            memcpy( &length, p, sizeof( length ) );
+            p += sizeof( length );
+
+            int bytes = length * ( tag == 'w' ? 2 : 1 );
+            if ( bytes < 0
+                 || p + bytes > end
+            ) {
+                return;
+            }
+
+            if ( tag == 'w' )
+            {
+                safeWriteUtf16( fd, p, length );
+            }
+            else
+            {
+                safeWrite( fd, p, bytes );
+            }
+            p += bytes;
+            continue;
+        }
+
+        if ( tag == 'p' )
+        {
+            void* pointer;
+            if ( p + sizeof( pointer ) > end )
+            {
+                return;
+            }
+            memcpy( &pointer, p, sizeof( pointer ) );
+            p += sizeof( pointer );
+
+            safeWriteString( fd, "0x" );
+            safeWriteNumber( fd, (quint64)(quintptr)pointer, false, 16, 1 );
+            continue;
+        }
+
+        if ( tag == 'D'
+             && !brace
+        ) {
+            p += sizeof( long double );
+            safeWriteString( fd, "<long double>" );
+            continue;
+        }
+
+        qint64 value;
+        if ( p + sizeof( value ) > end )
+        {
+            return;
+        }
+        memcpy( &value, p, sizeof( value ) );
+        p += sizeof( value );
+
+        switch ( tag )
+        {
+        case 'd':
+            safeWriteString( fd, "<double>" );
+            break;
+        case 'c':
+        {
+            char c = (char)value;
+            safeWrite( fd, &c, 1 );
+            break;
+        }
+        case 'b':
+            safeWriteString( fd, ( value ? "true" : "false" ) );
+            break;
+        case 'u':
+            safeWriteNumber( fd, (quint64)value, false, 10, 1 );
+            break;
+        default:
+            safeWriteInteger( fd, value );
+            break;
+        }
+    }
+}
+
+/** write record serialized by LogRecord#serialize as text line.
+ *
+ * async-signal-safe: uses only write(2) and stack memory,
+ * so may be called from fatal signal handler
+ * (see CrashHandler).
+ *
+ * formatted record is written as is, not formatted one --
+ * as raw timestamp, level, source location, thread tag,
+ * format and captured arguments.
+ *
+ * @param fd    file descriptor
+ * @param in    serialized record
+ * @param size  number of serialized bytes
+ */
+void LogRecord::dumpSerialized( int fd, const char* in, int size )
+{
+    SERIALIZED_RECORD header;
+    if ( size < (int)sizeof( header ) )
+    {
+        return;
+    }
+    memcpy( &header, in, sizeof( header ) );
+    const char* end = in + size;
+    in += sizeof( header );
+
+    int messageBytes = ( header.messageSize > 0 ? header.messageSize * 2 : 0 );
+    if ( header.threadTagSize < 0
+         || header.argumentsSize < 0
+         || header.dataSize < 0
+         || in + messageBytes + header.threadTagSize + header.argumentsSize > end
+    ) {
+        return;
+    }
+
+    if ( header.messageSize >= 0 )
+    {
+        safeWriteUtf16( fd, in, header.messageSize );
+        safeWrite( fd, "\n", 1 );
+        return;
+    }
+
+    const char* tag = in;
+    const char* arguments = tag + header.threadTagSize;
+
+    qint64 second = header.timestamp / Q_INT64_C( 1000000000 );
+    safeWriteInteger( fd, second );
+    safeWrite( fd, ".", 1 );
+    safeWriteNumber( fd, (quint64)( header.timestamp - second * Q_INT64_C( 1000000000 ) ), false, 10, 9 );
+    if ( header.sequence )
+    {
+        safeWriteString( fd, " #" );
+        safeWriteNumber( fd, header.sequence, false, 10, 0 );
+    }
+    safeWriteString( fd, " L" );
+    safeWriteInteger( fd, header.level );
+    safeWrite( fd, " ", 1 );
+    safeWriteString( fd, header.file );
+    safeWrite( fd, ":", 1 );
+    safeWriteInteger( fd, header.line );
+    safeWriteString( fd, " [" );
+    safeWrite( fd, tag, header.threadTagSize );
+    safeWriteString( fd, "] " );
+    safeWriteString( fd, header.function );
+    safeWrite( fd, " ", 1 );
+    safeWriteString( fd, header.format );
+    safeWriteString( fd, " |" );
+    safeWriteArguments( fd, arguments, arguments + header.argumentsSize, ( header.braceFormat != 0 ) );
+    safeWrite( fd, "\n", 1 );
+}
@@ -0,0 +1,252 @@
+// Copyright (c) 2012, Ilya Arefiev <arefiev.id@gmail.com>
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the
+//    distribution.
+//  * Neither the name of the author nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+// IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+// TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+// PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include    "libqtlogger_common.h"
+#include    "logrecordmerger.h"
+
+using namespace ilardm::lib::qtlogger;
+
+/** merger constructor.
+ *
+ * creates merger without sources.
+ */
+LogRecordMerger::LogRecordMerger()
+{
+}
+
+/** merger destructor.
+ *
+ * releases owned rings, records read ahead are lost.
+ */
+LogRecordMerger::~LogRecordMerger()
+{
+    while ( !sources.isEmpty() )
+    {
+        SOURCE* source = sources.takeFirst();
+        if ( source->owned
+             && source->ring->release()
+        ) {
+            delete source->ring;
+        }
+        delete source;
+    }
+}
+
+/** add ring to merge.
+ *
+ * owned ring is released (see LogRingBuffer#release) and
+ * removed from merger once it is drained and nobody else
+ * owns it.
+ *
+ * @param ring  ring to merge
+ * @param owned merger owns one reference to ring
+ */
+void LogRecordMerger::addSource( LogRingBuffer* ring, bool owned )
+{
+    SOURCE* source = new SOURCE();
+    source->ring = ring;
+    source->owned = owned;
+    source->hasPending = false;
+    source->pendingAt = 0;
+    source->hasBarrier = false;
+    source->barrier = 0;
+
+    sources.append( source );
+}
+
+/** get the oldest record of all rings.
+ *
+ * reads ahead one record from each ring which has none,
+ * removes drained rings abandoned by other owners,
+ * chooses the oldest record read ahead.
+ *
+ * @param record    record to fill
+ * @param now       current time, nanoseconds since epoch
+ * @param skew      skew window, nanoseconds
+ * @param holdUntil set to time the oldest record may be returned
+ *                  at if it is held by skew window, 0 otherwise
+ *
+ * @return true if record returned<br>
+ *         false if there are no records or the oldest one is held
+ */
+bool LogRecordMerger::next( LogRecord& record, qint64 now, qint64 skew, qint64* holdUntil )
+{
+    SOURCE* oldest = NULL;
+    bool complete = true;
+
+    *holdUntil = 0;
+
+    for ( int i = 0; i < sources.size(); )
+    {
+        SOURCE* source = sources[ i ];
+
+        if ( !source->hasPending )
+        {
+            // check owners before emptiness: abandoned ring gets no more records
+            bool abandoned = ( source->owned && !source->ring->isShared() );
+
+            source->pendingAt = source->ring->consumedPosition();
+            source->hasPending = source->ring->pop( source->pending );
+            if ( !source->hasPending )
+            {
+                if ( abandoned
+                     && source->ring->isEmpty()
+                ) {
+                    if ( source->ring->release() )
+                    {
+                        delete source->ring;
+                    }
+                    delete source;
+                    sources.removeAt( i );
+                    continue;
+                }
+
+                complete = false;
+                i++;
+                continue;
+            }
+        }
+
+        if ( !oldest
+             || source->pending.timestamp < oldest->pending.timestamp
+        ) {
+            oldest = source;
+        }
+        i++;
+    }
+
+    if ( !oldest )
+    {
+        return false;
+    }
+
+    if ( !complete
+         && oldest->pending.timestamp > now - skew
+    ) {
+        *holdUntil = oldest->pending.timestamp + skew;
+        return false;
+    }
+
+    record = oldest->pending;
+    oldest->hasPending = false;
+
+    return true;
+}
+
+/** check whether merger has nothing to return.
+ *
+ * @return true if no records read ahead and all rings are empty<br>
+ *         false otherwise
+ */
+bool LogRecordMerger::isIdle() const
+{
+    for ( int i = 0; i < sources.size(); i++ )
+    {
+        if ( sources[ i ]->hasPending
+             || !sources[ i ]->ring->isEmpty()
+        ) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/** check whether merger may have record to return.
+ *
+ * @return true if any record read ahead or any ring
+ *         has published record<br>
+ *         false if rings are empty or their oldest records
+ *         are not published yet
+ */
+bool LogRecordMerger::isReady() const
+{
+    for ( int i = 0; i < sources.size(); i++ )
+    {
+        if ( sources[ i ]->hasPending
+             || sources[ i ]->ring->isReady()
+        ) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/** remember current reservation position of each ring.
+ *
+ * see LogRecordMerger#passedBarrier. rings added later
+ * are not covered by barrier.
+ */
+void LogRecordMerger::setBarrier()
+{
+    for ( int i = 0; i < sources.size(); i++ )
+    {
+        sources[ i ]->barrier = sources[ i ]->ring->reservedPosition();
+        sources[ i ]->hasBarrier = true;
+    }
+}
+
+/** check whether all records reserved before
+ * LogRecordMerger#setBarrier are returned.
+ *
+ * records discarded from rings by producers count as returned.
+ * removed rings are drained, so pass barrier as well.
+ *
+ * @return true if barrier passed<br>
+ *         false otherwise
+ */
+bool LogRecordMerger::passedBarrier() const
+{
+    for ( int i = 0; i < sources.size(); i++ )
+    {
+        const SOURCE* source = sources[ i ];
+        if ( !source->hasBarrier )
+        {
+            continue;
+        }
+
+        // positions wrap around 2^32
+        uint position = ( source->hasPending ? source->pendingAt : source->ring->consumedPosition() );
+        if ( (int)( position - source->barrier ) < 0 )
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/** get number of merged rings.
+ *
+ * @return number of rings
+ */
+int LogRecordMerger::sourcesCount() const
+{
+    return sources.size();
+}
@@ -0,0 +1,439 @@
+// Copyright (c) 2012, Ilya Arefiev <arefiev.id@gmail.com>
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the
+//    distribution.
+//  * Neither the name of the author nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+// IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+// TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+// PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include    <string.h>
+
+#include    "libqtlogger_common.h"
+#include    "logringbuffer.h"
+
+using namespace ilardm::lib::qtlogger;
+
+/** size of record header: published record length,
+ * keeps record payload 8-byte aligned
+ */
+#define LQTL_RING_HEADER_SIZE   8
+
+/** existing rings, see LogRingBuffer#dumpAll.
+ *
+ * POD array: zero-initialized before any ring is created
+ */
+static QBasicAtomicPointer< LogRingBuffer > ringRegistry[ LogRingBuffer::MAX_REGISTERED ];
+
+/** ring buffer constructor.
+ *
+ * rounds capacity up to power of 2,
+ * allocates zeroed ring memory and registers ring
+ * for LogRingBuffer#dumpAll. ring is owned by
+ * its creator only.
+ *
+ * @param capacity ring size in bytes
+ */
+LogRingBuffer::LogRingBuffer( int capacity )
+    : ring( NULL ),
+      ringSize( 64 ),
+      tail( 0 ),
+      records( 0 ),
+      head( 0 ),
+      references( 1 )
+{
+    while ( ringSize < (uint)capacity
+            && ringSize < ( 1u << 30 )
+    ) {
+        ringSize <<= 1;
+    }
+
+    // qint64 array for alignment
+    ring = (char*)new qint64[ ringSize / sizeof( qint64 ) ];
+    memset( ring, 0, ringSize );
+
+    // rings above registry size are not dumped
+    for ( int i = 0; i < MAX_REGISTERED; i++ )
+    {
+        if ( ringRegistry[ i ].testAndSetOrdered( NULL, this ) )
+        {
+            break;
+        }
+    }
+}
+
+/** ring buffer destructor.
+ *
+ * unregisters ring and frees ring memory,
+ * not consumed records are lost.
+ */
+LogRingBuffer::~LogRingBuffer()
+{
+    for ( int i = 0; i < MAX_REGISTERED; i++ )
+    {
+        if ( ringRegistry[ i ].testAndSetOrdered( this, NULL ) )
+        {
+            break;
+        }
+    }
+
+    delete[] (qint64*)ring;
+}
+
+/** get ring size.
+ *
+ * @return ring size in bytes
+ */
+int LogRingBuffer::capacity() const
+{
+    return (int)ringSize;
+}
+
+/** get number of queued records.
+ *
+ * @return number of published not consumed records
+ */
+int LogRingBuffer::size() const
+{
+    return (int)records;
+}
+
+/** get space record takes in ring.
+ *
+ * @param record log record
+ *
+ * @return header and serialized record size aligned to 8 bytes
+ */
+int LogRingBuffer::recordSize( const LogRecord& record ) const
+{
+    return ( LQTL_RING_HEADER_SIZE + record.serializedSize() + 7 ) & ~7;
+}
+
+/** check whether record may ever be pushed.
+ *
+ * record at most half of ring size fits regardless
+ * of where ring end is. bytes limit of LogRingBuffer#tryPush
+ * does not matter: larger record is pushed into empty ring.
+ *
+ * @param record    log record
+ *
+ * @return true if record is not larger than half of ring<br>
+ *         false otherwise
+ */
+bool LogRingBuffer::fits( const LogRecord& record ) const
+{
+    return ( (uint)recordSize( record ) <= ringSize / 2 );
+}
+
+/** get header of record at ring offset.
+ *
+ * @param offset offset in ring, 8-byte aligned
+ *
+ * @return record header
+ */
+QBasicAtomicInt* LogRingBuffer::headerAt( uint offset )
+{
+    return (QBasicAtomicInt*)( ring + offset );
+}
+
+/** push record without waiting (producer side).
+ *
+ * may be called from any number of threads concurrently.
+ *
+ * reserves space with compare-and-swap on LogRingBuffer#tail,
+ * serializes record and publishes it by storing its size into
+ * record header. if record does not fit before ring end --
+ * the rest of ring is published as padding and record is placed
+ * at ring start.
+ *
+ * limits are soft: concurrent producers may exceed
+ * LogRingBuffer#size limit by their number. bytes limit
+ * applies to occupied space only, so record larger than
+ * limit is pushed once ring is empty.
+ *
+ * @param record        log record, should fit into ring (see LogRingBuffer#fits)
+ * @param maxRecords    records limit, 0 for no limit
+ * @param maxBytes      bytes limit, 0 for ring size
+ *
+ * @return true if record pushed<br>
+ *         false if ring is full at the moment
+ */
+bool LogRingBuffer::tryPush( const LogRecord& record, int maxRecords, int maxBytes )
+{
+    if ( maxRecords > 0
+         && (int)records >= maxRecords
+    ) {
+        return false;
+    }
+
+    uint size = recordSize( record );
+    uint mask = ringSize - 1;
+    uint limit = ( maxBytes > 0 ? qMin( (uint)maxBytes, ringSize ) : ringSize );
+
+    uint position = 0;
+    uint needed = 0;
+    for ( ;; )
+    {
+        // head first: it never passes tail read after it.
+        // full barrier of compare-and-swap below orders this read
+        // before writes into reserved space
+        uint consumed = (uint)(int)head;
+        position = (uint)(int)tail;
+
+        if ( (int)( position - consumed ) < 0 )
+        {
+            // reads reordered and consumer advanced in between:
+            // difference underflowed, ring is not full
+            continue;
+        }
+
+        uint toEnd = ringSize - ( position & mask );
+        needed = ( toEnd < size ) ? toEnd + size : size;
+
+        uint used = position - consumed;
+        if ( used + needed > ringSize
+             || ( used > 0
+                  && used + needed > limit )
+        ) {
+            return false;
+        }
+
+        if ( tail.testAndSetOrdered( (int)position, (int)( position + needed ) ) )
+        {
+            break;
+        }
+    }
+
+    uint offset = position & mask;
+    if ( needed != size )
+    {
+        // padding till ring end
+        headerAt( offset )->fetchAndStoreOrdered( -(int)( needed - size ) );
+        offset = 0;
+    }
+
+    record.serialize( ring + offset + LQTL_RING_HEADER_SIZE );
+    headerAt( offset )->fetchAndStoreOrdered( (int)size );
+    records.ref();
+
+    return true;
+}
+
+/** pop the oldest record (consumer side).
+ *
+ * must not be called from several threads concurrently.
+ *
+ * skips padding and records failed to deserialize, zeroes
+ * consumed space so headers read on next pass over the ring
+ * are unpublished and advances LogRingBuffer#head.
+ *
+ * @param record record to restore popped one into
+ *
+ * @return true if record popped<br>
+ *         false if ring is empty or the oldest record
+ *         is not published yet
+ */
+bool LogRingBuffer::pop( LogRecord& record )
+{
+    uint mask = ringSize - 1;
+    uint position = (uint)(int)head;
+
+    for ( ;; )
+    {
+        uint offset = position & mask;
+        int size = headerAt( offset )->fetchAndAddAcquire( 0 );
+
+        if ( size == 0 )
+        {
+            return false;
+        }
+
+        bool restored = false;
+        bool padding = ( size < 0 );
+        if ( padding )
+        {
+            size = -size;
+        }
+        else
+        {
+            restored = record.deserialize( ring + offset + LQTL_RING_HEADER_SIZE,
+                                           size - LQTL_RING_HEADER_SIZE );
+        }
+
+        memset( ring + offset, 0, size );
+        position += size;
+        head.fetchAndStoreOrdered( (int)position );
+
+        if ( !padding )
+        {
+            // broken record is consumed as well
+            records.deref();
+        }
+        if ( restored )
+        {
+            return true;
+        }
+    }
+}
+
+/** check whether ring has no reserved records.
+ *
+ * @return true if ring is empty<br>
+ *         false otherwise
+ */
+bool LogRingBuffer::isEmpty() const
+{
+    return ( (int)head == (int)tail );
+}
+
+/** check whether the oldest record is published.
+ *
+ * unlike LogRingBuffer#isEmpty is false while the oldest
+ * record is reserved but not published yet, so consumer
+ * may park instead of polling until producer publishes it.
+ *
+ * @return true if LogRingBuffer#pop would return record<br>
+ *         false otherwise
+ */
+bool LogRingBuffer::isReady() const
+{
+    uint mask = ringSize - 1;
+    uint position = (uint)(int)head;
+
+    if ( position == (uint)(int)tail )
+    {
+        return false;
+    }
+
+    int size = ((QBasicAtomicInt*)( ring + ( position & mask ) ))->fetchAndAddAcquire( 0 );
+    if ( size < 0 )
+    {
+        // padding is published with record placed at ring start
+        size = ((QBasicAtomicInt*)( ring + ( ( position - size ) & mask ) ))->fetchAndAddAcquire( 0 );
+    }
+
+    return ( size > 0 );
+}
+
+/** get position next record will be reserved at.
+ *
+ * every record reserved before the call lies before
+ * returned position (see LogRingBuffer#tail).
+ *
+ * @return LogRingBuffer#tail
+ */
+uint LogRingBuffer::reservedPosition() const
+{
+    return (uint)(int)tail;
+}
+
+/** get position of the oldest not consumed record.
+ *
+ * @return LogRingBuffer#head
+ */
+uint LogRingBuffer::consumedPosition() const
+{
+    return (uint)(int)head;
+}
+
+/** add one more ring owner.
+ */
+void LogRingBuffer::acquire()
+{
+    references.ref();
+}
+
+/** remove ring owner.
+ *
+ * @return true if caller was the last owner and should delete ring<br>
+ *         false otherwise
+ */
+bool LogRingBuffer::release()
+{
+    return !references.deref();
+}
+
+/** check whether ring has more than one owner.
+ *
+ * @return true if ring has several owners<br>
+ *         false if caller is the only owner
+ */
+bool LogRingBuffer::isShared() const
+{
+    return ( (int)references > 1 );
+}
+
+/** write not consumed records as text.
+ *
+ * async-signal-safe (see LogRecord#dumpSerialized).
+ * stops at the first record not published yet.
+ *
+ * @param fd file descriptor to write to
+ */
+void LogRingBuffer::dump( int fd ) const
+{
+    uint mask = ringSize - 1;
+    uint position = (uint)(int)head;
+    uint end = (uint)(int)tail;
+
+    // bounded: ring may be modified concurrently
+    for ( uint step = 0;
+          position != end && step < ringSize / LQTL_RING_HEADER_SIZE;
+          step++
+    ) {
+        uint offset = position & mask;
+        int size = *(volatile int*)( ring + offset );
+
+        if ( size == 0
+             || (uint)( size < 0 ? -size : size ) > ringSize - offset
+        ) {
+            return;
+        }
+
+        if ( size > 0 )
+        {
+            LogRecord::dumpSerialized( fd,
+                                       ring + offset + LQTL_RING_HEADER_SIZE,
+                                       size - LQTL_RING_HEADER_SIZE );
+        }
+        position += ( size < 0 ? -size : size );
+    }
+}
+
+/** write not consumed records of all rings as text.
+ *
+ * async-signal-safe. rings are dumped one after another,
+ * records of different rings are not merged.
+ *
+ * @param fd file descriptor to write to
+ */
+void LogRingBuffer::dumpAll( int fd )
+{
+    for ( int i = 0; i < MAX_REGISTERED; i++ )
+    {
+        LogRingBuffer* ring = ringRegistry[ i ];
+        if ( ring )
+        {
+            ring->dump( fd );
+        }
+    }
+}
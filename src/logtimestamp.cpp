@@ -0,0 +1,135 @@
+// Copyright (c) 2012, Ilya Arefiev <arefiev.id@gmail.com>
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the
+//    distribution.
+//  * Neither the name of the author nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+// IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+// TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+// PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include    <string.h>
+#include    <time.h>
+
+#include    <QDateTime>
+#include    <QThreadStorage>
+
+#include    "libqtlogger_common.h"
+#include    "logtimestamp.h"
+
+using namespace ilardm::lib::qtlogger;
+
+/** per-thread cache of formatted current second.
+ */
+typedef struct {
+    qint64  second;                             /**< cached second since epoch */
+    bool    withDate;                           /**< date included into LogTimestamp#text */
+    char    text[ LogTimestamp::MAX_LENGTH ];   /**< formatted date/time of LogTimestamp#second */
+    int     length;                             /**< length of LogTimestamp#text */
+} TIMESTAMP_CACHE;
+
+/** read current time.
+ *
+ * uses clock_gettime(2) on Linux (served by vDSO without syscall),
+ * QDateTime with milliseconds resolution on other platforms.
+ *
+ * @return nanoseconds since epoch
+ */
+qint64 LogTimestamp::now()
+{
+#if defined ( Q_OS_LINUX )
+    struct timespec ts;
+    clock_gettime( CLOCK_REALTIME, &ts );
+
+    return (qint64)ts.tv_sec * Q_INT64_C( 1000000000 ) + ts.tv_nsec;
+#else
+    return QDateTime::currentMSecsSinceEpoch() * Q_INT64_C( 1000000 );
+#endif
+}
+
+/** format timestamp read by LogTimestamp#now.
+ *
+ * formats date/time in local time zone only once per second
+ * per thread, then appends fraction of second with requested
+ * precision.
+ *
+ * @param timestamp nanoseconds since epoch
+ * @param precision number of fraction digits
+ * @param withDate  prepend time with date (yyyy-MM-dd)
+ * @param out       buffer of at least LogTimestamp#MAX_LENGTH bytes
+ *
+ * @return length of formatted timestamp
+ */
+int LogTimestamp::format( qint64 timestamp, PRECISION precision, bool withDate, char* out )
+{
+    static QThreadStorage< TIMESTAMP_CACHE* > caches;
+
+    if ( !caches.hasLocalData() )
+    {
+        TIMESTAMP_CACHE* cache = new TIMESTAMP_CACHE();
+        cache->second = -1;
+        cache->withDate = false;
+        cache->length = 0;
+        caches.setLocalData( cache );
+    }
+    TIMESTAMP_CACHE* cache = caches.localData();
+
+    qint64 second = timestamp / Q_INT64_C( 1000000000 );
+    int fraction = (int)( timestamp % Q_INT64_C( 1000000000 ) );
+    if ( fraction < 0 )
+    {
+        second--;
+        fraction += 1000000000;
+    }
+
+    if ( cache->second != second
+         || cache->withDate != withDate
+    ) {
+        QByteArray text = QDateTime::fromMSecsSinceEpoch( second * 1000 )
+                            .toString( withDate ? "yyyy-MM-dd hh:mm:ss" : "hh:mm:ss" )
+                            .toLatin1();
+
+        cache->length = qMin( text.size(), MAX_LENGTH - 11 );
+        memcpy( cache->text, text.constData(), cache->length );
+        cache->second = second;
+        cache->withDate = withDate;
+    }
+
+    int length = cache->length;
+    memcpy( out, cache->text, length );
+
+    int digits = qMin( qMax( (int)precision, 1 ), 9 );
+    for ( int i = digits; i < 9; i++ )
+    {
+        fraction /= 10;
+    }
+
+    out[ length++ ] = '.';
+    for ( int i = digits - 1; i >= 0; i-- )
+    {
+        out[ length + i ] = (char)( '0' + fraction % 10 );
+        fraction /= 10;
+    }
+    length += digits;
+    out[ length ] = '\0';
+
+    return length;
+}
@@ -43,3 +43,72 @@ LogWriterInterface::~LogWriterInterface()
 {
 }
 
+/** batch log writer function.
+ *
+ * called by logger thread with all messages formed
+ * since previous call. default implementation passes
+ * messages one by one to LogWriterInterface#writeLog,
+ * reimplementing class may write them at once.
+ *
+ * @param messages log messages
+ *
+ * @return true if all log messages wrote successfully<br>
+ *         false otherwise
+ */
+bool LogWriterInterface::writeLogBatch( QStringList& messages )
+{
+    bool status = true;
+
+    for ( int i = 0; i < messages.size(); i++ )
+    {
+        status = writeLog( messages[ i ] ) && status;
+    }
+
+    return status;
+}
+
+
+/** flush written messages.
+ *
+ * called by logger thread on QtLogger#flush request.
+ * reimplementing class should pass buffered messages
+ * to the underlying device. default implementation
+ * does nothing.
+ *
+ * @return true if messages flushed successfully<br>
+ *         false otherwise
+ */
+bool LogWriterInterface::flush()
+{
+    return true;
+}
+
+/** write out buffered messages without waiting.
+ *
+ * called by logger thread when it runs out of messages
+ * and after messages of QtLogger#flushLevel are written
+ * (see QtLogger#setFlushLevel). unlike LogWriterInterface#flush
+ * must not wait for other threads. default implementation
+ * does nothing.
+ *
+ * @return true if messages written successfully<br>
+ *         false otherwise
+ */
+bool LogWriterInterface::sync()
+{
+    return true;
+}
+
+/** reopen underlying device.
+ *
+ * called by logger thread on QtLogger#reopenWriters request,
+ * i.e. after log file was renamed by external rotation tool.
+ * default implementation does nothing.
+ *
+ * @return true if device reopened successfully<br>
+ *         false otherwise
+ */
+bool LogWriterInterface::reopen()
+{
+    return true;
+}
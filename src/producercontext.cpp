@@ -0,0 +1,128 @@
+// Copyright (c) 2012, Ilya Arefiev <arefiev.id@gmail.com>
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//  * Redistributions of source code must retain the above copyright
+//    notice, this list of conditions and the following disclaimer.
+//  * Redistributions in binary form must reproduce the above copyright
+//    notice, this list of conditions and the following disclaimer in the
+//    documentation and/or other materials provided with the
+//    distribution.
+//  * Neither the name of the author nor the names of its
+//    contributors may be used to endorse or promote products derived
+//    from this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+// IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+// TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+// PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include    <stdio.h>
+
+#include    <QThread>
+#include    <QThreadStorage>
+
+#include    "libqtlogger_common.h"
+#include    "producercontext.h"
+#include    "logringbuffer.h"
+
+using namespace ilardm::lib::qtlogger;
+
+/** producer context constructor.
+ *
+ * stores current thread id, renders it as
+ * default ProducerContext#threadTag and preallocates
+ * ProducerContext#buffer
+ */
+ProducerContext::ProducerContext()
+    : threadId( (void*)QThread::currentThreadId() )
+{
+    setName( QString() );
+    buffer.resize( BUFFER_SIZE );
+}
+
+/** producer context destructor.
+ *
+ * releases ProducerContext#rings, so logger threads delete
+ * them after remaining records are consumed.
+ */
+ProducerContext::~ProducerContext()
+{
+    for ( int i = 0; i < rings.size(); i++ )
+    {
+        if ( rings[ i ].second->release() )
+        {
+            delete rings[ i ].second;
+        }
+    }
+}
+
+/** get context of current thread.
+ *
+ * creates context on first call from the thread.
+ * context is deleted by QThreadStorage on thread exit.
+ *
+ * @return context of current thread
+ */
+ProducerContext* ProducerContext::current()
+{
+    static QThreadStorage< ProducerContext* > contexts;
+
+    if ( !contexts.hasLocalData() )
+    {
+        contexts.setLocalData( new ProducerContext() );
+    }
+
+    return contexts.localData();
+}
+
+/** set name of thread context belongs to.
+ *
+ * name replaces thread id in prefix of subsequent
+ * messages of the thread. messages already queued
+ * keep previous tag.
+ *
+ * @param name thread name, null or empty to use thread id
+ */
+void ProducerContext::setName( const QString& name )
+{
+    if ( name.isEmpty() )
+    {
+        char id[ 32 ];
+        snprintf( id, sizeof( id ), "%p", threadId );
+        threadTag = QByteArray( id );
+    }
+    else
+    {
+        threadTag = name.toUtf8();
+    }
+}
+
+/** find thread's own ring of logger instance.
+ *
+ * @param owner logger instance id (see QtLogger#instanceId)
+ *
+ * @return ring from ProducerContext#rings<br>
+ *         or NULL if thread has no ring for this instance yet
+ */
+LogRingBuffer* ProducerContext::ring( int owner ) const
+{
+    for ( int i = 0; i < rings.size(); i++ )
+    {
+        if ( rings[ i ].first == owner )
+        {
+            return rings[ i ].second;
+        }
+    }
+
+    return NULL;
+}
@@ -11,6 +11,7 @@
 #include    "libqtlogger.h"
 #include    "consoleappender.h"
 #include    "fileappender.h"
+#include    "asyncappender.h"
 
 using namespace ilardm::lib::qtlogger;
 
@@ -24,7 +25,8 @@ int main( int argc, char** argv )
     LQTL_START_LOGGING( &settings );
     LQTL_UNUSED_VARIABLE( __qtLoggerConfigFileSet );
     LQTL_ADD_LOG_WRITER( new ConsoleAppender() );
-    LQTL_ADD_LOG_WRITER( new FileAppender( QString("test-application.log") ));
+    LQTL_ADD_LOG_WRITER( new AsyncAppender( QtLogger::getInstance(),
+                                            new FileAppender( QString("test-application.log") ) ));
 
     LOG_DEBUG("startup");
     LOG_DEBUGX( "argv[0]: '%s' hex:",
@@ -97,6 +99,12 @@ int main( int argc, char** argv )
     QString smth("qstring test");
     LOG_DEBUG( "smth: %s", LQTL_QSTRINGCHAR(smth) );
 
+#ifdef Q_COMPILER_VARIADIC_TEMPLATES
+    // type-safe logging: no conversion for QString
+    TLOG_DEBUG( "smth: '{}' i: {} buf: {}", smth, i, buf );
+    TLOG_WARNX( "{{hex}} of '{}':", buf, strlen(buf), QByteArray( buf ) );
+#endif
+
     std::cout << "press enter to continue" << std::endl;
     getchar();
 
@@ -141,7 +149,7 @@ int main( int argc, char** argv )
     LOG_DEBUG("log-level on-air editing");
     std::clog << "press enter to continue" << std::endl;
     getchar();
-    QMap< QString, QtLogger::MODULE_LEVEL* > mmap = LQTL_GET_KNOWN_MODULES_LEVELS();
+    QMap< QString, QtLogger::MODULE_LEVEL > mmap = LQTL_GET_KNOWN_MODULES_LEVELS();
     QList< QString > mm_modules = mmap.keys();
     QStringList ll_strings = LQTL_GET_LLEVELS_DESCRIPTION();
     foreach ( QString module, mm_modules )
@@ -149,8 +157,8 @@ int main( int argc, char** argv )
         std::cout << "module: "
                 << module.toStdString()
                 << "\tlevel: "
-                << mmap.value( module )->level
-                << " '" << ll_strings[ mmap.value( module )->level ].toStdString() << "'"
+                << mmap.value( module ).level
+                << " '" << ll_strings[ mmap.value( module ).level ].toStdString() << "'"
                 << std::endl;
     }
 
@@ -177,8 +185,8 @@ int main( int argc, char** argv )
         std::cout << "module: "
                 << module.toStdString()
                 << "\tlevel: "
-                << mmap.value( module )->level
-                << " '" << ll_strings[ mmap.value( module )->level ].toStdString() << "'"
+                << mmap.value( module ).level
+                << " '" << ll_strings[ mmap.value( module ).level ].toStdString() << "'"
                 << std::endl;
     }
     // restore log level